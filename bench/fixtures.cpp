@@ -0,0 +1,197 @@
+#include "fixtures.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/fmt/fmt.h>
+
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+constexpr std::array<std::string_view, 4> CODENAMES = { "bullseye", "bookworm", "trixie", "sid" };
+constexpr std::array<std::string_view, 6> PREFIXES = { "", "lib", "python-", "golang-", "node-", "ruby-" };
+constexpr std::array<std::string_view, 8> WORDS = { "ssl", "xml", "image", "http",
+                                                     "crypto", "archive", "font", "sql" };
+constexpr std::array<std::string_view, 4> URGENCIES = { "not yet assigned", "low", "medium", "high" };
+
+/// FNV-1a, unlike std::hash the same everywhere
+std::uint64_t seedOf(std::string_view str) {
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (const char c : str) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+std::string version(std::uint64_t r) {
+    return fmt::format("{}.{}.{}-{}", r % 5, (r >> 4) % 20, (r >> 12) % 30, (r >> 20) % 4 + 1);
+}
+
+void appendCve(std::string& buffer, const std::string& cveId, std::uint64_t seed, std::size_t releases) {
+    auto out = std::back_inserter(buffer);
+    fmt::format_to(out,
+                   R"("{}":{{"description":"Flaw number {} in the generated package","scope":"{}",)"
+                   R"("debianbug":{},"releases":{{)",
+                   cveId,
+                   seed % 100000,
+                   seed % 3 == 0 ? "local" : "remote",
+                   900000 + seed % 100000);
+    for (std::size_t i = 0; i < releases; ++i) {
+        const auto r = bench::random(seed + i);
+        const auto codename = CODENAMES[i % CODENAMES.size()];
+        const auto fixed = version(r);
+        // Most of the records are resolved, like in the real dump
+        const auto status = r % 10 < 7 ? "resolved" : r % 10 < 9 ? "open" : "undetermined";
+        fmt::format_to(out,
+                       R"({}"{}":{{"status":"{}","repositories":{{"{}":"{}"}},)",
+                       i > 0 ? "," : "",
+                       codename,
+                       status,
+                       codename,
+                       version(r >> 3));
+        if (status == std::string_view("resolved")) {
+            fmt::format_to(out, R"("fixed_version":"{}",)", fixed);
+        }
+        fmt::format_to(out, R"("urgency":"{}"}})", URGENCIES[(r >> 32) % URGENCIES.size()]);
+    }
+    buffer += "}}";
+}
+
+std::filesystem::path makeFixtureRoot() {
+    auto pattern = (std::filesystem::temp_directory_path() / "cveinfo-bench-XXXXXX").string();
+    if (!mkdtemp(pattern.data())) {
+        throw std::runtime_error("Failed to create the fixture directory");
+    }
+    return pattern;
+}
+
+} // namespace
+
+std::string bench::packageName(std::size_t package) {
+    const auto r = bench::random(package);
+    return fmt::format("{}{}{}", PREFIXES[r % PREFIXES.size()], WORDS[(r >> 8) % WORDS.size()], package);
+}
+
+std::string bench::cveIdAt(std::size_t index) {
+    return fmt::format("CVE-{}-{:04}", 2000 + index % 25, 1000 + index / 25);
+}
+
+void bench::writeTracker(std::ostream& output, const TrackerShape& shape) {
+    std::string buffer;
+    output << '{';
+    for (std::size_t package = 0; package < shape.packages; ++package) {
+        buffer.clear();
+        buffer += package > 0 ? ",\"" : "\"";
+        buffer += bench::packageName(package);
+        buffer += "\":{";
+        for (std::size_t i = 0; i < shape.cvesPerPackage; ++i) {
+            // Consecutive records of a package never share a CVE, records of different packages may
+            const auto record = package * shape.cvesPerPackage + i;
+            if (i > 0) {
+                buffer += ',';
+            }
+            appendCve(buffer, cveIdAt(record % shape.cves()), random(record), shape.releasesPerCve);
+        }
+        buffer += '}';
+        output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+    output << '}';
+}
+
+std::string bench::makeNvdResponse(const std::string& cveId, std::size_t scale) {
+    const auto seed = random(seedOf(cveId));
+
+    json cpeMatch = json::array();
+    for (std::size_t i = 0; i < 20 * scale; ++i) {
+        cpeMatch.push_back({ { "vulnerable", true },
+                             { "criteria", fmt::format("cpe:2.3:a:vendor:product:{}:*:*:*:*:*:*:*", i) },
+                             { "matchCriteriaId", fmt::format("{:016X}", random(seed + i)) } });
+    }
+    json references = json::array();
+    for (std::size_t i = 0; i < 10 * scale; ++i) {
+        references.push_back({ { "url", fmt::format("https://example.com/advisories/{}/{}", cveId, i) },
+                               { "source", "secalert@example.com" },
+                               { "tags", json::array({ "Patch", "Third Party Advisory" }) } });
+    }
+
+    const json cve = {
+        { "id", cveId },
+        { "sourceIdentifier", "secalert@example.com" },
+        { "published", "2023-03-01T12:15:10.150" },
+        { "lastModified", "2024-01-10T08:20:41.017" },
+        { "vulnStatus", "Analyzed" },
+        { "descriptions",
+          { { { "lang", "en" },
+              { "value", fmt::format("A buffer overflow in the generated product {} allows remote attackers "
+                                     "to execute arbitrary code via a crafted request.",
+                                     seed % 1000) } },
+            { { "lang", "es" }, { "value", "Un desbordamiento de búfer en el producto generado." } } } },
+        { "metrics",
+          { { "cvssMetricV31",
+              { { { "source", "nvd@nist.gov" },
+                  { "type", "Primary" },
+                  { "cvssData",
+                    { { "version", "3.1" },
+                      { "vectorString", "CVSS:3.1/AV:N/AC:L/PR:N/UI:N/S:U/C:H/I:H/A:H" },
+                      { "attackVector", "NETWORK" },
+                      { "attackComplexity", "LOW" },
+                      { "privilegesRequired", "NONE" },
+                      { "userInteraction", "NONE" },
+                      { "scope", "UNCHANGED" },
+                      { "confidentialityImpact", "HIGH" },
+                      { "integrityImpact", "HIGH" },
+                      { "availabilityImpact", "HIGH" },
+                      { "baseScore", 9.8 },
+                      { "baseSeverity", "CRITICAL" } } },
+                  { "exploitabilityScore", 3.9 },
+                  { "impactScore", 5.9 } } } } } },
+        { "weaknesses",
+          { { { "source", "nvd@nist.gov" },
+              { "type", "Primary" },
+              { "description", { { { "lang", "en" }, { "value", "CWE-787" } } } } } } },
+        { "configurations", { { { "nodes", { { { "operator", "OR" }, { "cpeMatch", cpeMatch } } } } } } },
+        { "references", references },
+    };
+    return json{ { "resultsPerPage", 1 },
+                 { "startIndex", 0 },
+                 { "totalResults", 1 },
+                 { "format", "NVD_CVE" },
+                 { "version", "2.0" },
+                 { "timestamp", "2024-01-10T09:00:00.000" },
+                 { "vulnerabilities", { { { "cve", cve } } } } }
+        .dump();
+}
+
+const std::filesystem::path& bench::trackerCacheDir(std::size_t scale) {
+    static std::map<std::size_t, std::filesystem::path> dirs;
+    if (const auto it = dirs.find(scale); it != std::end(dirs)) {
+        return it->second;
+    }
+
+    const auto dir = fixtureRoot() / fmt::format("scale-{}", scale);
+    std::filesystem::create_directories(dir / "cveinfo");
+    std::ofstream output(dir / "cveinfo" / "debian-tracker.json", std::ios::binary);
+    writeTracker(output, TrackerShape::realistic().scaled(scale));
+    if (!output) {
+        throw std::runtime_error("Failed to write the tracker fixture");
+    }
+    return dirs.emplace(scale, dir).first->second;
+}
+
+const std::filesystem::path& bench::fixtureRoot() {
+    static const auto root = makeFixtureRoot();
+    return root;
+}
+
+void bench::removeFixtures() {
+    std::error_code ec;
+    std::filesystem::remove_all(fixtureRoot(), ec);
+}
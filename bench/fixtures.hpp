@@ -0,0 +1,63 @@
+#ifndef CVEINFO_BENCH_FIXTURES_HPP_
+#define CVEINFO_BENCH_FIXTURES_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+
+namespace cveinfo::bench {
+
+/// Size of a generated debian security tracker dump.
+struct TrackerShape {
+    std::size_t packages;
+    std::size_t cvesPerPackage;
+    std::size_t releasesPerCve;
+
+    /// Roughly the size of the real tracker dump
+    static TrackerShape realistic() { return { 4000, 25, 4 }; }
+
+    TrackerShape scaled(std::size_t factor) const {
+        return { packages * factor, cvesPerPackage, releasesPerCve };
+    }
+
+    std::size_t records() const { return packages * cvesPerPackage; }
+
+    /// Number of distinct CVE IDs, some CVEs affect several packages like in the real dump
+    std::size_t cves() const { return records() * 3 / 4; }
+};
+
+/// Deterministic pseudo-random number of @p seed, the same on every platform and standard library.
+constexpr std::uint64_t random(std::uint64_t seed) {
+    std::uint64_t z = seed + 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+/// Source package name number @p package of the generated fixtures.
+std::string packageName(std::size_t package);
+
+/// CVE ID number @p index of the generated fixtures.
+std::string cveIdAt(std::size_t index);
+
+/// Writes a debian security tracker dump of @p shape to @p output.
+void writeTracker(std::ostream& output, const TrackerShape& shape);
+
+/// Returns an NVD API response for @p cveId; @p scale multiplies its configurations and references.
+std::string makeNvdResponse(const std::string& cveId, std::size_t scale);
+
+/// Cache directory of the fixtures of @p scale, usable as XDG_CACHE_HOME.
+///
+/// The tracker dump of TrackerShape::realistic() scaled by @p scale is generated on first use.
+const std::filesystem::path& trackerCacheDir(std::size_t scale);
+
+/// Temporary directory holding all fixtures.
+const std::filesystem::path& fixtureRoot();
+
+void removeFixtures();
+
+} // namespace cveinfo::bench
+
+#endif // CVEINFO_BENCH_FIXTURES_HPP_
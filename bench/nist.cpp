@@ -0,0 +1,55 @@
+#include "fixtures.hpp"
+
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/nist.hpp"
+#include "cveinfo/cve/schema.hpp"
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <spdlog/fmt/fmt.h>
+
+#include <chrono>
+#include <vector>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+/// What getCveDescription() does with an NVD response: parsing it and extracting the description.
+void nvdResponseParse(benchmark::State& state) {
+    const auto body = bench::makeNvdResponse("CVE-2023-1234", static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        const auto response = json::parse(body);
+        benchmark::DoNotOptimize(nist::parseCve(*nist::schema::FIRST_CVE.find(response)));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(body.size()));
+}
+
+/// getCveDescription() answered from the store, the common case of a repeated lookup.
+void getCveDescriptionCached(benchmark::State& state) {
+    const auto records = static_cast<std::size_t>(state.range(0));
+    const auto dir = bench::fixtureRoot() / fmt::format("store-{}", records);
+    std::filesystem::create_directories(dir);
+    nist::Store store(dir / "nvd.store");
+
+    std::vector<nist::CveDescription> descriptions;
+    for (std::size_t i = 0; i < records; ++i) {
+        const auto cveId = bench::cveIdAt(i);
+        const auto response = json::parse(bench::makeNvdResponse(cveId, 1));
+        descriptions.push_back(nist::parseCve(response["vulnerabilities"][0]["cve"]));
+    }
+    store.put(descriptions, std::chrono::system_clock::now());
+
+    const utils::Freshness freshness{ std::chrono::hours(24), std::chrono::hours(24) };
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const auto& cveId = descriptions[bench::random(i++) % records].cveId;
+        benchmark::DoNotOptimize(nist::getCveDescription(cveId, std::nullopt, store, freshness));
+    }
+}
+
+} // namespace
+
+BENCHMARK(nvdResponseParse)->Arg(1)->Arg(10);
+BENCHMARK(getCveDescriptionCached)->Arg(1000)->Arg(10000);
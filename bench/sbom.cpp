@@ -0,0 +1,59 @@
+#include "fixtures.hpp"
+
+#include "cveinfo/sbom.hpp"
+
+#include <benchmark/benchmark.h>
+#include <spdlog/fmt/fmt.h>
+
+#include <iterator>
+#include <string>
+
+using namespace cveinfo;
+
+namespace {
+
+/// CycloneDX document of @p components debian packages, shaped like the output of common SBOM generators.
+std::string makeCycloneDx(std::size_t components) {
+    std::string document = R"({"bomFormat":"CycloneDX","specVersion":"1.5","components":[)";
+    auto out = std::back_inserter(document);
+    for (std::size_t i = 0; i < components; ++i) {
+        const auto name = bench::packageName(i % 4000);
+        const auto r = bench::random(i);
+        fmt::format_to(out,
+                       R"({}{{"type":"library","bom-ref":"pkg-{}","name":"{}","version":"{}.{}-{}",)"
+                       R"("purl":"pkg:deb/debian/{}@{}.{}-{}?arch=amd64&distro=debian-12",)"
+                       R"("licenses":[{{"license":{{"id":"MIT"}}}}],)"
+                       R"("properties":[{{"name":"syft:package:type","value":"deb"}}]}})",
+                       i == 0 ? "" : ",",
+                       i,
+                       name,
+                       r % 10,
+                       (r >> 8) % 30,
+                       (r >> 16) % 4 + 1,
+                       name,
+                       r % 10,
+                       (r >> 8) % 30,
+                       (r >> 16) % 4 + 1);
+    }
+    document += "]}";
+    return document;
+}
+
+/// Extracting the components of an SBOM, before any of them is matched.
+void sbomParse(benchmark::State& state) {
+    const auto document = makeCycloneDx(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::size_t components = 0;
+        sbom::parse(document, [&components](sbom::Component&& component) {
+            benchmark::DoNotOptimize(component);
+            ++components;
+            return true;
+        });
+        benchmark::DoNotOptimize(components);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(document.size()));
+}
+
+} // namespace
+
+BENCHMARK(sbomParse)->Arg(10000)->Arg(50000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,122 @@
+#include "fixtures.hpp"
+
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/TrackerIndex.hpp"
+#include "cveinfo/cve/TrackerParser.hpp"
+#include "cveinfo/utils/MappedFile.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+using namespace cveinfo;
+
+namespace {
+
+// The fixture is written right before the benchmarks, it never needs a download
+const utils::Freshness FRESHNESS{ std::chrono::hours(24), std::chrono::hours(24) };
+
+std::filesystem::path trackerPath(std::size_t scale) {
+    return bench::trackerCacheDir(scale) / "cveinfo" / "debian-tracker.json";
+}
+
+/// Points the tracker at the fixture of @p scale and indexes it.
+debian::DebianSecurityTracker openTracker(std::size_t scale) {
+    setenv("XDG_CACHE_HOME", bench::trackerCacheDir(scale).c_str(), 1);
+    return debian::DebianSecurityTracker(std::nullopt, FRESHNESS);
+}
+
+/// Parsing and indexing a freshly downloaded dump, the cold start of a lookup.
+void trackerIndexBuild(benchmark::State& state) {
+    const auto scale = static_cast<std::size_t>(state.range(0));
+    const auto path = trackerPath(scale);
+    const auto indexPath = bench::fixtureRoot() / "build.idx";
+    const auto source = debian::TrackerIndex::SourceStamp::of(path);
+    for (auto _ : state) {
+        std::ifstream input(path);
+        debian::TrackerIndex::Builder builder;
+        debian::TrackerParser(builder, std::nullopt).parse(input);
+        builder.write(indexPath, source);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(source.size));
+}
+
+/// Finding the package boundaries, the part of an index build that doesn't run on all cores.
+void trackerSplit(benchmark::State& state) {
+    const auto scale = static_cast<std::size_t>(state.range(0));
+    const utils::MappedFile file(trackerPath(scale));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(debian::TrackerParser::splitPackages(file.view()));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(file.size()));
+}
+
+/// Opening an up to date index, the warm start of a lookup.
+void trackerLoad(benchmark::State& state) {
+    const auto scale = static_cast<std::size_t>(state.range(0));
+    openTracker(scale);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(debian::DebianSecurityTracker(std::nullopt, FRESHNESS));
+    }
+}
+
+void getTrackerInfo(benchmark::State& state) {
+    const auto scale = static_cast<std::size_t>(state.range(0));
+    const auto tracker = openTracker(scale);
+
+    std::vector<CveId> cveIds;
+    const auto cves = bench::TrackerShape::realistic().scaled(scale).cves();
+    for (std::size_t i = 0; i < 1024; ++i) {
+        cveIds.push_back(*CveId::parse(bench::cveIdAt(bench::random(i) % cves)));
+    }
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tracker.getTrackerInfo(cveIds[i++ % cveIds.size()]));
+    }
+}
+
+/// Resolving package names as found in SBOMs, @p transform turns a source package name into the query.
+template <typename TTransform>
+void resolvePackage(benchmark::State& state, TTransform transform) {
+    const auto tracker = openTracker(1);
+    // Built on first use, not part of the measurement
+    tracker.resolvePackage("");
+
+    std::vector<std::string> names;
+    const auto packages = bench::TrackerShape::realistic().packages;
+    for (std::size_t i = 0; i < 1024; ++i) {
+        names.push_back(transform(bench::packageName(bench::random(i) % packages)));
+    }
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tracker.resolvePackage(names[i++ % names.size()], 1));
+    }
+}
+
+std::string sourceName(std::string name) {
+    return name;
+}
+
+std::string binaryName(std::string name) {
+    return name + "-dev";
+}
+
+std::string misspelledName(std::string name) {
+    std::swap(name[1], name[2]);
+    return name;
+}
+
+} // namespace
+
+BENCHMARK(trackerIndexBuild)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK(trackerSplit)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK(trackerLoad)->Arg(1)->Arg(10)->Unit(benchmark::kMicrosecond);
+BENCHMARK(getTrackerInfo)->Arg(1)->Arg(10);
+BENCHMARK_CAPTURE(resolvePackage, source, sourceName);
+BENCHMARK_CAPTURE(resolvePackage, binary, binaryName);
+BENCHMARK_CAPTURE(resolvePackage, misspelled, misspelledName);
@@ -0,0 +1,102 @@
+#include "fixtures.hpp"
+
+#include "cveinfo/CveId.hpp"
+#include "cveinfo/utils/json.hpp"
+#include "cveinfo/utils/stringUtils.hpp"
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+const std::string BASE_SCORE = "/vulnerabilities/0/cve/metrics/cvssMetricV31/0/cvssData/baseScore";
+
+const json& nvdResponse() {
+    static const json response = json::parse(bench::makeNvdResponse("CVE-2023-1234", 1));
+    return response;
+}
+
+void getAsHit(benchmark::State& state) {
+    const auto& response = nvdResponse();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils::getAs<float>(response, BASE_SCORE));
+    }
+}
+
+/// Records without CVSS data
+void getAsMiss(benchmark::State& state) {
+    const auto& response = nvdResponse();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            utils::getAs<json>(response, "/vulnerabilities/0/cve/metrics/cvssMetricV40/0/cvssData"));
+    }
+}
+
+/// The same lookups through fields parsed at compile time
+void jsonFieldHit(benchmark::State& state) {
+    static constexpr utils::JsonField<float> FIELD(
+        "/vulnerabilities/0/cve/metrics/cvssMetricV31/0/cvssData/baseScore");
+    const auto& response = nvdResponse();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FIELD(response));
+    }
+}
+
+void jsonFieldMiss(benchmark::State& state) {
+    static constexpr utils::JsonPointer POINTER("/vulnerabilities/0/cve/metrics/cvssMetricV40/0/cvssData");
+    const auto& response = nvdResponse();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(POINTER.find(response));
+    }
+}
+
+/// A line of a batch file
+void tokenizeQuery(benchmark::State& state) {
+    const std::string line = "CVE-2023-1234   openssl\t# comment";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils::tokenize(
+            line,
+            [](const char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; },
+            utils::TokenizeMode::EXCLUDE_EMPTY_TOKENS));
+    }
+}
+
+/// Validating and packing the CVE IDs of queries and tracker records
+void cveIdParse(benchmark::State& state) {
+    std::vector<std::string> cveIds;
+    for (std::size_t i = 0; i < 1024; ++i) {
+        cveIds.push_back(bench::cveIdAt(bench::random(i)));
+    }
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CveId::parse(cveIds[i++ % cveIds.size()]));
+    }
+}
+
+void tokenizeDelimiter(benchmark::State& state) {
+    std::string str;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(state.range(0)); ++i) {
+        str += bench::cveIdAt(i) + ", ";
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils::tokenize(str, ", "));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(str.size()));
+}
+
+} // namespace
+
+BENCHMARK(getAsHit);
+BENCHMARK(getAsMiss);
+BENCHMARK(jsonFieldHit);
+BENCHMARK(jsonFieldMiss);
+BENCHMARK(tokenizeQuery);
+BENCHMARK(cveIdParse);
+BENCHMARK(tokenizeDelimiter)->Arg(100)->Arg(1000);
@@ -0,0 +1,57 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CONTEXT_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CONTEXT_HPP_
+
+#include "cveinfo/batch.hpp"
+#include "cveinfo/export.h"
+#include "cveinfo/options.hpp"
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace cveinfo {
+
+/// Long-lived lookup context for services embedding cveinfo instead of running it per lookup.
+///
+/// The context owns the debian security tracker, the NVD cache and the NVD request workers. The tracker is
+/// loaded once and refreshed in the background every trackerFreshness.maxAge; queries in flight keep using
+/// the tracker they started with. All members are thread safe.
+///
+/// Results are the objects of batch mode: the CVE ID, the NVD description (null if unavailable) and the
+/// debian tracker records, or the CVE ID and an "error" message.
+class CVEINFO_EXPORT Context {
+public:
+    using Callback = std::function<void(nlohmann::json result)>;
+
+    /// Loads the debian security tracker, downloading it first if needed. Throws if it can't be loaded.
+    explicit Context(Options options);
+    /// Waits for the queries in flight.
+    ~Context();
+
+    Context(const Context&) = delete;
+    Context& operator=(const Context&) = delete;
+
+    /// Resolves @p query without blocking on the NVD.
+    ///
+    /// @p done is called from the calling thread when the NVD record is cached and from an NVD worker
+    /// otherwise, so it shouldn't block for long. It must not throw.
+    void query(batch::Query query, Callback done);
+
+    std::future<nlohmann::json> query(batch::Query query);
+
+    /// Queues all of @p queries at once, their NVD requests are sent concurrently.
+    std::vector<std::future<nlohmann::json>> query(std::vector<batch::Query> queries);
+
+    const Options& options() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace cveinfo
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CONTEXT_HPP_
@@ -0,0 +1,127 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVEID_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVEID_HPP_
+
+#include <spdlog/fmt/fmt.h>
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace cveinfo {
+
+/// CVE identifier ("CVE-<year>-<sequence number>") packed into a 64-bit integer of its year and sequence
+/// number, which compares, hashes and sorts like an integer: by year, then numerically by sequence number.
+///
+/// IDs are validated once, when they're parsed. A default constructed CveId is empty and sorts before all
+/// IDs.
+class CveId {
+public:
+    static constexpr std::uint16_t MIN_YEAR = 1999;
+
+    constexpr CveId() = default;
+
+    constexpr CveId(std::uint16_t year, std::uint32_t sequence)
+        : mValue(std::uint64_t(year) << 32 | sequence) {}
+
+    /// Parses an ID in the syntax of the CVE program: a year of 4 digits and a sequence number of at least 4
+    /// digits, zero-padded only up to 4 digits. The prefix is case-insensitive, "cve-2024-1234" is parsed as
+    /// CVE-2024-1234.
+    ///
+    /// Returns std::nullopt for anything else, e.g. the "TEMP-" IDs of the debian security tracker.
+    static constexpr std::optional<CveId> parse(std::string_view str) {
+        if (str.size() < 13 || (str[0] | 0x20) != 'c' || (str[1] | 0x20) != 'v' || (str[2] | 0x20) != 'e' ||
+            str[3] != '-' || str[8] != '-') {
+            return std::nullopt;
+        }
+        const auto digits = str.substr(9);
+        // Longer sequence numbers wouldn't fit 32 bits
+        if (digits.size() > 9 || (digits.size() > 4 && digits[0] == '0')) {
+            return std::nullopt;
+        }
+        const auto year = number(str.substr(4, 4));
+        const auto sequence = number(digits);
+        if (!year || *year < MIN_YEAR || !sequence) {
+            return std::nullopt;
+        }
+        return CveId(static_cast<std::uint16_t>(*year), *sequence);
+    }
+
+    /// Inverse of value()
+    static constexpr CveId fromValue(std::uint64_t value) {
+        CveId id;
+        id.mValue = value;
+        return id;
+    }
+
+    /// First ID of @p year, for range queries
+    static constexpr CveId firstOf(std::uint16_t year) { return CveId(year, 0); }
+
+    /// Last ID of @p year, for range queries
+    static constexpr CveId lastOf(std::uint16_t year) {
+        return CveId(year, std::numeric_limits<std::uint32_t>::max());
+    }
+
+    constexpr std::uint16_t year() const { return static_cast<std::uint16_t>(mValue >> 32); }
+
+    constexpr std::uint32_t sequence() const { return static_cast<std::uint32_t>(mValue); }
+
+    /// The packed ID, 0 if it's empty
+    constexpr std::uint64_t value() const { return mValue; }
+
+    constexpr bool empty() const { return mValue == 0; }
+
+    /// The ID in its canonical form, an empty string if it's empty
+    std::string str() const {
+        return empty() ? std::string() : fmt::format("CVE-{}-{:04}", year(), sequence());
+    }
+
+    friend constexpr auto operator<=>(const CveId&, const CveId&) = default;
+
+private:
+    /// Value of the decimal number @p digits, std::nullopt if it's empty or not all digits.
+    static constexpr std::optional<std::uint32_t> number(std::string_view digits) {
+        if (digits.empty()) {
+            return std::nullopt;
+        }
+        std::uint32_t value = 0;
+        for (const char c : digits) {
+            if (c < '0' || c > '9') {
+                return std::nullopt;
+            }
+            value = value * 10 + static_cast<std::uint32_t>(c - '0');
+        }
+        return value;
+    }
+
+    std::uint64_t mValue = 0;
+};
+
+static_assert(sizeof(CveId) == sizeof(std::uint64_t));
+static_assert(CveId::parse("CVE-2024-1234") == CveId(2024, 1234));
+static_assert(CveId::parse("cve-2024-0042") == CveId(2024, 42));
+static_assert(CveId::parse("CVE-2024-123456") > CveId::parse("CVE-2024-99999"));
+static_assert(!CveId::parse("CVE-2024-123") && !CveId::parse("CVE-2024-01234"));
+static_assert(!CveId::parse("CVE-2024-12x4") && !CveId::parse("CVE-24-123456"));
+static_assert(!CveId::parse("TEMP-0000000-1D5F2A"));
+
+} // namespace cveinfo
+
+template <>
+struct std::hash<cveinfo::CveId> {
+    std::size_t operator()(const cveinfo::CveId& id) const { return std::hash<std::uint64_t>{}(id.value()); }
+};
+
+template <>
+struct fmt::formatter<cveinfo::CveId> : fmt::formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(const cveinfo::CveId& id, FormatContext& ctx) const {
+        return fmt::formatter<std::string_view>::format(id.str(), ctx);
+    }
+};
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVEID_HPP_
@@ -0,0 +1,45 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_BATCH_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_BATCH_HPP_
+
+#include "cveinfo/cve/nist.hpp"
+#include "cveinfo/options.hpp"
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+
+namespace cveinfo::debian {
+class DebianSecurityTracker;
+}
+
+namespace cveinfo::batch {
+
+struct Query {
+    /// As given, it's parsed by resolve()
+    std::string cveId;
+    std::optional<std::string> packageName;
+};
+
+/// Parses a "<CVE ID> [package-name]" line, returns std::nullopt for empty and comment lines.
+std::optional<Query> parseQuery(const std::string& line);
+
+/// Joins @p description and the debian tracker records of @p query into one result object, or returns an
+/// error object if the CVE ID of @p query is malformed.
+nlohmann::json resolve(const debian::DebianSecurityTracker& tracker,
+                       const Query& query,
+                       const std::optional<nist::CveDescription>& description,
+                       const Options& options);
+
+/// Resolves every "<CVE ID> [package-name]" line of @p input and streams the results to @p output as
+/// newline delimited JSON, one object per input line.
+///
+/// The debian security tracker is loaded once for the whole batch. Empty lines and lines starting with '#'
+/// are skipped.
+int run(std::istream& input, std::ostream& output, const Options& options);
+
+} // namespace cveinfo::batch
+
+#endif // CVEINFO_INCLUDE_CVEINFO_BATCH_HPP_
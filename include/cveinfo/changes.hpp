@@ -0,0 +1,89 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CHANGES_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CHANGES_HPP_
+
+#include "cveinfo/CveId.hpp"
+#include "cveinfo/cve/TrackerIndex.hpp"
+#include "cveinfo/cve/nist.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Feed of the changes found by refreshing the local databases.
+///
+/// Whenever a tracker download is indexed, the new index is diffed against the previous one, and whenever
+/// an NVD record is fetched again, it's diffed against the cached one. The changes are appended to a file
+/// of JSON lines in the cache directory, so following the feed tells what changed without querying
+/// everything again.
+namespace cveinfo::changes {
+
+struct Change {
+    enum class Type {
+        /// The tracker lists a CVE for a package it didn't list it for before
+        NEW_CVE,
+        /// The tracker doesn't list the CVE for the package anymore
+        REMOVED_CVE,
+        /// The tracker status of a release changed, e.g. from open to resolved
+        STATUS,
+        /// A release got a (different) fixed version
+        FIXED_VERSION,
+        /// The CVSS base score of an NVD record changed
+        SCORE,
+    };
+
+    Type type;
+    CveId cveId;
+    /// Source package of tracker changes
+    std::optional<std::string> package;
+    /// Release of status and fixed version changes
+    std::optional<std::string> codename;
+    /// Previous and new status, fixed version or score; null if there was none
+    nlohmann::json from;
+    nlohmann::json to;
+};
+
+void to_json(nlohmann::json& j, const Change& change);
+
+/// Returns the changes between the tracker indexes @p before and @p after, ordered by package and CVE ID.
+///
+/// Packages whose JSON hashes the same in both are skipped without comparing their records.
+std::vector<Change> diff(const debian::TrackerIndex& before, const debian::TrackerIndex& after);
+
+/// Returns the change of the CVSS base score from @p before to @p after, if any.
+std::optional<Change> diff(const nist::CveDescription& before, const nist::CveDescription& after);
+
+/// Returns the score changes of @p descriptions from the records of @p store they're about to replace.
+std::vector<Change> diff(nist::Store& store, const std::vector<nist::CveDescription>& descriptions);
+
+/// Path of the feed, rotated to feedPath() + ".1" once it grows over a few MiB.
+std::filesystem::path feedPath();
+
+/// Appends @p changes to the feed as one line each, stamped with the current time.
+///
+/// Several processes may publish at once, each call's lines are appended together.
+void publish(const std::vector<Change>& changes);
+
+/// Reads the changes published to the feed as they come, like tail -f.
+class Follower {
+public:
+    /// Starts at the end of the feed, only changes published from now on are read.
+    Follower();
+
+    /// Returns the changes published since the previous call, as written to the feed.
+    std::vector<nlohmann::json> poll();
+
+private:
+    void read(const std::filesystem::path& path, std::vector<nlohmann::json>& changes);
+
+    std::filesystem::path mPath;
+    std::uint64_t mInode = 0;
+    std::uint64_t mOffset = 0;
+};
+
+} // namespace cveinfo::changes
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CHANGES_HPP_
@@ -0,0 +1,29 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CPE_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CPE_HPP_
+
+#include "cveinfo/options.hpp"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cveinfo::cpe {
+
+struct Query {
+    /// CPE 2.3 name, e.g. cpe:2.3:a:openssl:openssl:3.0.7:*:*:*:*:*:*:*
+    std::string name;
+    /// Whether @p name is a match string, e.g. cpe:2.3:a:openssl:openssl matching all the versions
+    bool virtualMatch = false;
+};
+
+/// Streams the CVEs of the products named by @p queries to @p output as newline delimited JSON, one
+/// object per CVE and query, as the NVD result pages arrive.
+///
+/// The pages of all the queries are requested concurrently within the NVD rate limit, and only the pages
+/// being processed are held in memory. The records are put in the NVD cache, so following lookups of
+/// these CVEs are answered from it.
+int run(const std::vector<Query>& queries, std::ostream& output, const Options& options);
+
+} // namespace cveinfo::cpe
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CPE_HPP_
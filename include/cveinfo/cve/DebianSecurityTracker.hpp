@@ -1,11 +1,18 @@
 #ifndef CVEINFO_INCLUDE_CVEINFO_CVE_DEBIANSECURITYTRACKER_HPP_
 #define CVEINFO_INCLUDE_CVEINFO_CVE_DEBIANSECURITYTRACKER_HPP_
 
-#include <nlohmann/json.hpp>
+#include "cveinfo/CveId.hpp"
+#include "cveinfo/cve/PackageResolver.hpp"
+#include "cveinfo/cve/TrackerIndex.hpp"
+#include "cveinfo/refresh.hpp"
+#include "cveinfo/utils/utils.hpp"
 
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace cveinfo::debian {
 
@@ -17,23 +24,76 @@ struct CodenameInfo {
 
 struct TrackerInfo {
     std::string packageName;
-    std::string cveId;
+    CveId cveId;
     std::vector<CodenameInfo> codenames;
 };
 
 class DebianSecurityTracker {
 public:
-    DebianSecurityTracker(std::optional<std::string> codename);
+    enum class RefreshMode {
+        /// A stale database is used as is and refreshed by a background process
+        BACKGROUND,
+        /// A stale database is refreshed before it's used
+        FOREGROUND,
+    };
 
-    std::vector<TrackerInfo> getTrackerInfo(const std::string& cveId) const;
+    /// Loads the database, downloading it first if it's missing or expired.
+    ///
+    /// Concurrent processes share a single download: the first one downloads while the others wait for it.
+    DebianSecurityTracker(std::optional<std::string> codename,
+                          const utils::Freshness& freshness,
+                          RefreshMode refreshMode = RefreshMode::BACKGROUND);
+
+    /// Downloads the database if it isn't fresh and indexes it for @p codename, unless another process is
+    /// already refreshing it. Run by the background process of RefreshMode::BACKGROUND.
+    static bool refresh(const std::optional<std::string>& codename, const utils::Freshness& freshness);
+
+    /// Path of the downloaded database. Its metadata and indexes are next to it, named after it.
+    static std::filesystem::path databasePath();
+
+    /// Waits for the download in progress, if any, and holds off the next ones, e.g. to replace the database.
+    static refresh::Lease lockDatabase();
+
+    std::vector<TrackerInfo> getTrackerInfo(CveId cveId) const;
+
+    /// Returns the records of all CVEs affecting @p packageName, ordered by CVE ID.
+    ///
+    /// Only the releases having @p status are listed if given; CVEs without any such release are left out.
+    std::vector<TrackerInfo> getPackageInfo(const std::string& packageName,
+                                            const std::optional<std::string>& status = std::nullopt) const;
+
+    /// Ranks the source package names of the tracker by how likely @p packageName (e.g. a binary package
+    /// name from an SBOM) is built from them, best first. The names are valid as long as the tracker.
+    ///
+    /// The resolver index is built on first use.
+    std::vector<PackageResolver::Match> resolvePackage(std::string_view packageName,
+                                                       std::size_t limit = 5) const;
 
 private:
-    bool updateDebianSecurityTrackerDb(const std::filesystem::path& dbPath) const;
+    struct LazyResolver {
+        std::once_flag built;
+        std::optional<PackageResolver> resolver;
+    };
+
+    CodenameInfo makeCodenameInfo(const TrackerIndex::Release& release) const;
+
+    static bool updateDebianSecurityTrackerDb(const std::filesystem::path& dbPath);
+    static TrackerIndex openIndex(const std::filesystem::path& dbPath,
+                                  const std::optional<std::string>& codename);
 
     std::optional<std::string> mCodename;
-    nlohmann::json mJsonDatabase;
+    std::optional<TrackerIndex> mIndex;
+    std::unique_ptr<LazyResolver> mResolver = std::make_unique<LazyResolver>();
 };
 
+/// Finds the entry of @p infos affecting @p packageName.
+///
+/// The entries are scored like PackageResolver ranks package names: an exact match first, then known and
+/// derived source package names of a binary package name, then the most similar name. Returns
+/// std::end(infos) if no entry scores at least PackageResolver::MIN_SCORE.
+std::vector<TrackerInfo>::const_iterator findPackage(const std::vector<TrackerInfo>& infos,
+                                                     const std::string& packageName);
+
 } // namespace cveinfo::debian
 
 #endif // CVEINFO_INCLUDE_CVEINFO_CVE_DEBIANSECURITYTRACKER_HPP_
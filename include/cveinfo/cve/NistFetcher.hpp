@@ -0,0 +1,107 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVE_NISTFETCHER_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVE_NISTFETCHER_HPP_
+
+#include "cveinfo/utils/RateLimiter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace cveinfo::nist {
+
+/// Worker pool sending concurrent requests to the NIST NVD API.
+///
+/// Requests are paced by a sliding window set to the published NVD rate limits (which are higher with an
+/// API key) or to CVEINFO_NVD_RATE_LIMIT requests per window. Rate limited requests are rescheduled
+/// according to their Retry-After header or with a jittered exponential backoff, without holding up the
+/// other requests in flight.
+class Fetcher {
+public:
+    using Callback = std::function<void(std::optional<std::string> body)>;
+
+    struct Stats {
+        std::size_t requests = 0;
+        std::size_t forbidden = 0;
+        std::size_t retries = 0;
+        std::size_t failures = 0;
+        std::chrono::steady_clock::duration elapsed{};
+
+        double requestsPerSecond() const;
+    };
+
+    explicit Fetcher(std::optional<std::string> apiKey, std::size_t workers = 8);
+    ~Fetcher();
+
+    Fetcher(const Fetcher&) = delete;
+    Fetcher& operator=(const Fetcher&) = delete;
+
+    /// Queues a request of the NVD CVE API with the URL @p query (e.g. "cveId=CVE-2024-1234").
+    ///
+    /// @p done is called from a worker thread with the response body or std::nullopt if the request failed.
+    /// @p subject describes the request in log messages.
+    void fetch(std::string query, std::string subject, Callback done);
+
+    std::future<std::optional<std::string>> fetch(std::string query, std::string subject);
+
+    Stats stats() const;
+
+    /// Logs the throughput of the requests sent so far, if any.
+    void logStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        std::string query;
+        std::string subject;
+        Callback done;
+        int attempt = 0;
+        Clock::time_point queued = Clock::now();
+        Clock::time_point notBefore = queued;
+        /// Order of queueing, requests due at the same time are sent first in, first out
+        std::uint64_t sequence = 0;
+    };
+
+    struct Later {
+        bool operator()(const Request& lhs, const Request& rhs) const {
+            return std::tie(lhs.notBefore, lhs.sequence) > std::tie(rhs.notBefore, rhs.sequence);
+        }
+    };
+
+    void work();
+    void send(Request request);
+    void retry(Request request, Clock::duration delay);
+
+    const std::optional<std::string> mApiKey;
+    const std::string mUrl;
+    utils::RateLimiter mRateLimiter;
+    const Clock::time_point mStarted;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::priority_queue<Request, std::vector<Request>, Later> mQueue;
+    std::uint64_t mSequence = 0;
+    bool mStopping = false;
+
+    std::atomic<std::size_t> mRequests = 0;
+    std::atomic<std::size_t> mForbidden = 0;
+    std::atomic<std::size_t> mRetries = 0;
+    std::atomic<std::size_t> mFailures = 0;
+
+    std::vector<std::thread> mWorkers;
+};
+
+} // namespace cveinfo::nist
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVE_NISTFETCHER_HPP_
@@ -0,0 +1,42 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVE_NISTMIRROR_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVE_NISTMIRROR_HPP_
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+namespace cveinfo::nist {
+
+class Fetcher;
+class Store;
+
+/// Local mirror of the NIST NVD CVE database.
+///
+/// The first sync pages through the whole database, the following ones only pull the records modified
+/// since the previous sync. The records are kept in the NVD cache store flagged as mirrored, so lookups
+/// answered from it don't need any network round-trip.
+class Mirror {
+public:
+    explicit Mirror(Store& store, std::filesystem::path directory = defaultDirectory());
+
+    static std::filesystem::path defaultDirectory();
+
+    /// Brings the mirror up to date, returns false if any of the pages couldn't be retrieved.
+    bool sync(Fetcher& fetcher);
+
+private:
+    std::optional<std::chrono::system_clock::time_point> lastSync() const;
+    void setLastSync(std::chrono::system_clock::time_point time) const;
+    /// Stores the records of @p page, returns how many
+    std::size_t storePage(const nlohmann::json& page) const;
+
+    Store& mStore;
+    std::filesystem::path mDirectory;
+};
+
+} // namespace cveinfo::nist
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVE_NISTMIRROR_HPP_
@@ -0,0 +1,127 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVE_NISTSTORE_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVE_NISTSTORE_HPP_
+
+#include "cveinfo/cve/nist.hpp"
+#include "cveinfo/utils/MappedFile.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cveinfo::nist {
+
+/// Single-file cache of extracted NVD records.
+///
+/// Records are compressed with zstd and appended to one data file. An open-addressing hash table in a
+/// memory-mapped index file next to it locates them by their packed CveId, so a lookup is a probe and a
+/// single read. Records appended since the index was written are picked up from the tail of the data file
+/// until the tail grows big enough to be worth re-indexing.
+///
+/// When the data file outgrows its size limit or consists mostly of superseded records, it's compacted
+/// in the background and the least recently used records are evicted. Several processes may share one
+/// store; writers are serialized with a lock file.
+class Store {
+public:
+    /// The record comes from the NVD mirror and never goes stale
+    static constexpr std::uint16_t MIRRORED = 1;
+
+    static constexpr std::uint64_t DEFAULT_MAX_SIZE = 256 * 1024 * 1024;
+
+    struct Entry {
+        CveDescription description;
+        std::chrono::system_clock::time_point fetched;
+        std::uint16_t flags = 0;
+    };
+
+    /// Opens (or creates) the store and migrates the per-CVE cache files found next to it.
+    explicit Store(std::filesystem::path path = defaultPath(), std::uint64_t maxSize = DEFAULT_MAX_SIZE);
+    ~Store();
+
+    Store(const Store&) = delete;
+    Store& operator=(const Store&) = delete;
+
+    static std::filesystem::path defaultPath();
+
+    std::optional<Entry> get(CveId cveId);
+
+    void put(const CveDescription& description,
+             std::chrono::system_clock::time_point fetched,
+             std::uint16_t flags = 0);
+
+    /// Appends all @p descriptions at once, taking the writer lock just once.
+    void put(const std::vector<CveDescription>& descriptions,
+             std::chrono::system_clock::time_point fetched,
+             std::uint16_t flags = 0);
+
+    /// Rewrites the data file without superseded records, evicting the least recently used records if the
+    /// store is over its size limit.
+    void compact();
+
+    /// Writes a consistent copy of the data file and an index covering all of it to @p data and @p index,
+    /// to be installed into another store by importFrom().
+    void exportTo(const std::filesystem::path& data, const std::filesystem::path& index);
+
+    /// Replaces the contents of the store with the files written by exportTo(), moving them into place.
+    /// They have to be on the file system of the store. Throws if @p data is of an incompatible version.
+    void importFrom(const std::filesystem::path& data, const std::filesystem::path& index);
+
+private:
+    struct Slot {
+        /// Packed CveId, 0 for an empty slot
+        std::uint64_t key;
+        std::uint64_t offset;
+        std::uint32_t size;
+        std::uint32_t lastAccess;
+    };
+
+    struct IndexHeader;
+
+    void open();
+    void reopenIfReplaced();
+    void loadIndex();
+    void scanTail();
+    bool needsCompaction() const;
+    /// Starts compact() on a background thread if the store needs it and none is running, with mMutex held.
+    void compactInBackgroundIfNeeded();
+    void writeIndex();
+    static void writeIndexFile(const std::filesystem::path& path,
+                               const std::vector<Slot>& slots,
+                               std::uint64_t dataInode,
+                               std::uint64_t dataSize);
+    void migrate(const std::filesystem::path& directory);
+
+    Slot* findSlot(std::uint64_t key);
+    std::optional<Entry> read(const Slot& slot, CveId cveId) const;
+    std::vector<Slot> liveSlots() const;
+    void append(const std::vector<CveDescription>& descriptions,
+                std::chrono::system_clock::time_point fetched,
+                std::uint16_t flags);
+
+    std::filesystem::path mPath;
+    std::filesystem::path mIndexPath;
+    std::filesystem::path mLockPath;
+    const std::uint64_t mMaxSize;
+
+    // Guards the state below; writers take mWriteMutex and the lock file before it
+    mutable std::mutex mMutex;
+    std::mutex mWriteMutex;
+    int mFd = -1;
+    std::uint64_t mInode = 0;
+    std::optional<utils::MappedFile> mIndex;
+    // Records appended after the indexed part of the data file
+    std::unordered_map<std::uint64_t, Slot> mTail;
+    std::uint64_t mScanned = 0;
+    bool mCompacting = false;
+
+    std::thread mCompaction;
+};
+
+} // namespace cveinfo::nist
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVE_NISTSTORE_HPP_
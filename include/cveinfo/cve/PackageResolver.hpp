@@ -0,0 +1,76 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVE_PACKAGERESOLVER_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVE_PACKAGERESOLVER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cveinfo::debian {
+
+/// Maps package names as reported by SBOMs and scanners (binary package names like libssl3, python3-foo
+/// or foo-dev) to the source package names of the debian security tracker.
+///
+/// Candidates are ranked by confidence: the name itself, known binary to source package mappings, the name
+/// stripped of binary package affixes and soname versions, and finally the names sharing the most
+/// trigrams with it. The first kinds cost a few hash lookups; fuzzy matching only scores the names sharing
+/// at least one trigram with the query.
+class PackageResolver {
+public:
+    static constexpr float EXACT = 1.0f;
+    /// Lowest score of a match, below that names have too little in common
+    static constexpr float MIN_SCORE = 0.3f;
+    /// Highest score of a fuzzy match, the names derived from the package name rank above every one
+    static constexpr float FUZZY = 0.8f;
+
+    struct Match {
+        std::string_view name;
+        /// EXACT for the name itself, lower the less certain the match is
+        float score;
+    };
+
+    /// A package name prepared for matching, reusable against any number of candidates.
+    class Query {
+    public:
+        explicit Query(std::string_view packageName);
+
+        /// Scores @p candidate from 0 (nothing in common) to EXACT, the same way as PackageResolver ranks.
+        float score(std::string_view candidate) const;
+
+    private:
+        friend class PackageResolver;
+
+        float fuzzyScore(std::string_view candidate,
+                         std::size_t stemTrigrams,
+                         std::size_t shared,
+                         std::size_t candidateTrigrams) const;
+
+        /// Names derived from the package name, most certain first
+        std::vector<std::pair<std::string, float>> mDerived;
+        /// The package name without its binary package affixes, matched fuzzily
+        std::string mStem;
+    };
+
+    /// Indexes @p names, which have to outlive the resolver.
+    explicit PackageResolver(std::vector<std::string_view> names);
+
+    /// Returns the @p limit best matches of @p packageName scoring at least MIN_SCORE, best first.
+    std::vector<Match> resolve(std::string_view packageName, std::size_t limit = 5) const;
+
+    std::size_t size() const { return mNames.size(); }
+
+private:
+    std::vector<std::string_view> mNames;
+    std::unordered_map<std::string_view, std::uint32_t> mIds;
+    /// Trigram count of every name, by ID
+    std::vector<std::uint16_t> mTrigramCounts;
+    /// Names containing each trigram: (trigram, name ID) pairs sorted by trigram
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> mPostings;
+};
+
+} // namespace cveinfo::debian
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVE_PACKAGERESOLVER_HPP_
@@ -0,0 +1,217 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVE_TRACKERINDEX_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVE_TRACKERINDEX_HPP_
+
+#include "cveinfo/CveId.hpp"
+#include "cveinfo/utils/MappedFile.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace cveinfo::debian {
+
+/// Compact binary index mapping CVE IDs to the per-package records of the debian security tracker.
+///
+/// The index is built once per tracker download, stored next to the tracker database and memory-mapped
+/// on startup. A lookup is a binary search over the CVE table, sorted by packed CveId, instead of a scan over
+/// every package.
+/// A second table sorted by package name answers the reverse question, which CVEs affect a package.
+class TrackerIndex {
+public:
+    static constexpr std::uint32_t NO_STRING = 0xffffffff;
+
+    /// Identifies the tracker database the index was built from.
+    struct SourceStamp {
+        std::uint64_t size = 0;
+        std::int64_t mtime = 0;
+
+        static SourceStamp of(const std::filesystem::path& source);
+        bool operator==(const SourceStamp&) const = default;
+    };
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t sourceSize;
+        std::int64_t sourceMtime;
+        std::uint32_t cveCount;
+        std::uint32_t recordCount;
+        std::uint32_t releaseCount;
+        std::uint32_t stringsSize;
+        std::uint32_t packageCount;
+        std::uint32_t reserved2;
+    };
+
+    struct CveEntry {
+        /// Packed CveId, the table follows the header so it's 8-byte aligned
+        std::uint64_t id;
+        std::uint32_t firstRecord;
+        std::uint32_t recordCount;
+
+        CveId cveId() const { return CveId::fromValue(id); }
+    };
+
+    struct Record {
+        static constexpr std::uint32_t HAS_RELEASES = 1;
+
+        std::uint32_t package;
+        std::uint32_t firstRelease;
+        std::uint32_t releaseCount;
+        std::uint32_t flags;
+    };
+
+    struct Release {
+        std::uint32_t codename;
+        std::uint32_t status;
+        std::uint32_t fixedVersion;
+    };
+
+    struct PackageEntry {
+        std::uint32_t name;
+        std::uint32_t firstRecord;
+        std::uint32_t recordCount;
+        /// Hash of the JSON of the package in the tracker database, 0 if unknown. Split in halves, the
+        /// tables are only 4-byte aligned.
+        std::uint32_t sourceHashLow;
+        std::uint32_t sourceHashHigh;
+    };
+
+    /// Record of a package, referring to the CVE table and the record table
+    struct PackageRecord {
+        std::uint32_t cve;
+        std::uint32_t record;
+    };
+
+    /// Collects tracker records in any order and writes them out as a sorted index.
+    class Builder {
+    public:
+        /// Starts a new record of @p cveId affecting @p package; subsequent releases are added to it.
+        void addRecord(std::string_view package, CveId cveId, bool hasReleases);
+
+        void addRelease(std::string_view codename,
+                        std::optional<std::string_view> status,
+                        std::optional<std::string_view> fixedVersion);
+
+        /// Sets the hash of the JSON @p package was parsed from, see sourceHash().
+        void setSourceHash(std::string_view package, std::uint64_t hash);
+
+        /// Adds the records of package number @p package of @p index, with its source hash.
+        ///
+        /// @param codename If set, only releases of this codename are kept, as TrackerParser does.
+        void copyPackage(const TrackerIndex& index,
+                         std::size_t package,
+                         std::optional<std::string_view> codename = std::nullopt);
+
+        /// Adds the records of @p other after the ones of this builder, as if they had been added to it.
+        ///
+        /// Builders filled concurrently from consecutive parts of the tracker database merge into an index
+        /// with the same lookup results as a single builder filled from the whole database. Strings are
+        /// not deduplicated across builders.
+        void append(const Builder& other);
+
+        /// Atomically replaces @p indexPath with the collected records.
+        void write(const std::filesystem::path& indexPath, const SourceStamp& source) const;
+
+        std::size_t recordCount() const { return mRecords.size(); }
+
+    private:
+        struct PendingRecord {
+            CveId cveId;
+            Record record;
+        };
+
+        /// Looks up interned strings without copying the candidate
+        struct StringHash {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+        };
+
+        std::uint32_t intern(std::string_view str);
+        std::string_view string(std::uint32_t offset) const;
+
+        std::string mStrings;
+        std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> mStringIds;
+        std::unordered_map<std::string, std::uint64_t, StringHash, std::equal_to<>> mSourceHashes;
+        std::vector<PendingRecord> mRecords;
+        std::vector<Release> mReleases;
+    };
+
+    /// Maps @p indexPath, returns std::nullopt if it's missing, corrupted or not built from @p source.
+    ///
+    /// Without @p source, an index built from any database is opened, e.g. to update it.
+    static std::optional<TrackerIndex> open(const std::filesystem::path& indexPath,
+                                            const std::optional<SourceStamp>& source);
+
+    /// Returns the records of all packages affected by @p cveId, ordered by package name.
+    std::span<const Record> find(CveId cveId) const;
+
+    /// Returns the CVEs from @p first to @p last, both included, ordered by ID. E.g. the CVEs of 2024 are
+    /// cves(CveId::firstOf(2024), CveId::lastOf(2024)).
+    std::span<const CveEntry> cves(CveId first, CveId last) const;
+
+    /// Records of all packages affected by the CVE of @p entry, ordered by package name
+    std::span<const Record> records(const CveEntry& entry) const {
+        return mRecords.subspan(entry.firstRecord, entry.recordCount);
+    }
+
+    /// Returns the records of all CVEs affecting @p package, ordered by CVE ID.
+    std::span<const PackageRecord> findPackage(std::string_view package) const;
+
+    CveId cveId(const PackageRecord& packageRecord) const { return mCves[packageRecord.cve].cveId(); }
+
+    const Record& record(const PackageRecord& packageRecord) const { return mRecords[packageRecord.record]; }
+
+    std::span<const Release> releases(const Record& record) const {
+        return mReleases.subspan(record.firstRelease, record.releaseCount);
+    }
+
+    std::string_view string(std::uint32_t offset) const;
+
+    std::optional<std::string_view> optionalString(std::uint32_t offset) const {
+        return offset == NO_STRING ? std::nullopt : std::optional(string(offset));
+    }
+
+    std::size_t cveCount() const { return mCves.size(); }
+
+    std::size_t packageCount() const { return mPackages.size(); }
+
+    /// Name of package number @p i, in the order of the package table
+    std::string_view packageName(std::size_t i) const { return string(mPackages[i].name); }
+
+    /// Records of package number @p i, ordered by CVE ID
+    std::span<const PackageRecord> packageRecords(std::size_t i) const {
+        return mPackageRecords.subspan(mPackages[i].firstRecord, mPackages[i].recordCount);
+    }
+
+    /// Hash of the JSON package number @p i was parsed from, 0 if unknown. A package whose JSON hashes the
+    /// same in a newer database has the same records, so they can be taken over instead of parsed again.
+    std::uint64_t sourceHash(std::size_t i) const {
+        return std::uint64_t(mPackages[i].sourceHashHigh) << 32 | mPackages[i].sourceHashLow;
+    }
+
+    /// Number of @p package in the package table, std::nullopt if it has no records
+    std::optional<std::size_t> packageNumber(std::string_view package) const;
+
+private:
+    explicit TrackerIndex(utils::MappedFile file);
+
+    utils::MappedFile mFile;
+    std::span<const CveEntry> mCves;
+    std::span<const Record> mRecords;
+    std::span<const Release> mReleases;
+    std::span<const PackageEntry> mPackages;
+    std::span<const PackageRecord> mPackageRecords;
+    std::string_view mStrings;
+};
+
+} // namespace cveinfo::debian
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVE_TRACKERINDEX_HPP_
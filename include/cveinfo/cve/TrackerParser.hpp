@@ -0,0 +1,102 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVE_TRACKERPARSER_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVE_TRACKERPARSER_HPP_
+
+#include "cveinfo/CveId.hpp"
+#include "cveinfo/cve/TrackerIndex.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cveinfo::debian {
+
+/// SAX handler streaming the debian security tracker JSON into a TrackerIndex::Builder.
+///
+/// Only the fields the lookups use are kept (package, CVE ID and the status and fixed version of each
+/// release), so the memory needed depends on the extracted data and not on the size of the document.
+class TrackerParser : public nlohmann::json_sax<nlohmann::json> {
+public:
+    /// @param codename If set, only releases of this codename are kept.
+    TrackerParser(TrackerIndex::Builder& builder, std::optional<std::string> codename);
+
+    /// Member of the top-level object of the document, the CVEs of one source package.
+    struct Package {
+        std::string name;
+        std::string_view value;
+    };
+
+    /// Finds the packages of @p document without parsing their values, so they can be handed to
+    /// parsePackage() on several threads.
+    ///
+    /// Only the string and bracket structure is scanned, the values are validated when parsed. Returns
+    /// std::nullopt if @p document isn't an object, parse() then reports the error.
+    static std::optional<std::vector<Package>> splitPackages(std::string_view document);
+
+    /// Parses the whole document from @p input, throws nlohmann::json::parse_error on malformed input.
+    void parse(std::istream& input);
+
+    /// Parses the whole document held in memory.
+    void parse(std::string_view document);
+
+    /// Parses a single package found by splitPackages(), with the same results as parsing it as part of
+    /// the document.
+    void parsePackage(const Package& package);
+
+    bool null() override { return value(); }
+    bool boolean(bool) override { return value(); }
+    bool number_integer(number_integer_t) override { return value(); }
+    bool number_unsigned(number_unsigned_t) override { return value(); }
+    bool number_float(number_float_t, const string_t&) override { return value(); }
+    bool string(string_t& val) override;
+    bool binary(binary_t&) override { return value(); }
+    bool start_object(std::size_t) override;
+    bool end_object() override;
+    bool start_array(std::size_t) override;
+    bool end_array() override;
+    bool key(string_t& val) override;
+    bool parse_error(std::size_t position,
+                     const std::string& lastToken,
+                     const nlohmann::detail::exception& ex) override;
+
+private:
+    // Nesting depth of the values the parser is interested in
+    enum Depth : std::size_t {
+        ROOT = 1,
+        PACKAGE = 2,
+        CVE = 3,
+        RELEASES = 4,
+        RELEASE = 5,
+    };
+
+    struct PendingRelease {
+        std::string codename;
+        std::optional<std::string> status;
+        std::optional<std::string> fixedVersion;
+    };
+
+    bool value();
+    void beginValue();
+    void endValue();
+
+    TrackerIndex::Builder& mBuilder;
+    std::optional<std::string> mCodename;
+
+    std::size_t mDepth = 0;
+    std::size_t mArrays = 0;
+    std::string mKey;
+    std::string mPackage;
+    // std::nullopt for the "TEMP-" IDs of issues without a CVE yet, which aren't indexed
+    std::optional<CveId> mCveId;
+    bool mHasReleases = false;
+    bool mInReleases = false;
+    bool mSkipRelease = false;
+    std::vector<PendingRelease> mReleases;
+};
+
+} // namespace cveinfo::debian
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVE_TRACKERPARSER_HPP_
@@ -1,21 +1,78 @@
 #ifndef CVEINFO_INCLUDE_CVEINFO_CVE_NIST_HPP_
 #define CVEINFO_INCLUDE_CVEINFO_CVE_NIST_HPP_
 
+#include "cveinfo/CveId.hpp"
+#include "cveinfo/utils/utils.hpp"
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <functional>
+#include <future>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace cveinfo::nist {
 
 struct CveDescription {
-    std::string cveId;
+    CveId cveId;
     std::optional<std::string> description;
     std::optional<std::string> vectorString;
     std::optional<std::string> severity;
     std::optional<float> score;
 };
 
-std::optional<CveDescription> getCveDescription(const std::string& cveId,
-                                                const std::optional<std::string>& apiKey = std::nullopt);
+class Fetcher;
+class Store;
+
+/// Extracts the description of a "cve" object of an NVD API response. Its cveId is empty if the record has
+/// no valid CVE ID.
+CveDescription parseCve(const nlohmann::json& cve);
+
+/// Extracts the descriptions of all the records of a page of NVD API results.
+std::vector<CveDescription> parsePage(const nlohmann::json& page);
+
+/// Called with each parsed page of fetchPages(), returns false if it couldn't process it.
+using PageCallback = std::function<bool(const nlohmann::json& page)>;
+
+/// Pages through the results of the NVD API @p query (e.g. "cpeName=..."), with the largest pages the API
+/// allows. The first page tells how many results there are, the other pages are then requested
+/// concurrently through @p fetcher.
+///
+/// @p onPage is called from the workers of @p fetcher as the pages arrive, in no particular order, so at
+/// most one page per worker is held in memory. @p subject names the query in log messages.
+///
+/// Returns false if any page couldn't be retrieved or processed.
+bool fetchPages(Fetcher& fetcher, const std::string& query, const std::string& subject, PageCallback onPage);
+
+/// Looks @p cveId up for a single query: a stale record of @p store is answered right away and refreshed by a
+/// background process, so the caller doesn't wait for the NVD.
+std::optional<CveDescription> getCveDescription(CveId cveId,
+                                                const std::optional<std::string>& apiKey,
+                                                Store& store,
+                                                const utils::Freshness& freshness);
+
+using DescriptionCallback = std::function<void(std::optional<CveDescription> description)>;
+
+/// Answers from @p store right away unless its record expired, otherwise queues a request to @p fetcher and
+/// stores the response. Stale records are revalidated through @p fetcher in the background.
+///
+/// @p done is called from the calling thread for cached records and from a worker of @p fetcher otherwise.
+void getCveDescriptionAsync(CveId cveId,
+                            Fetcher& fetcher,
+                            Store& store,
+                            const utils::Freshness& freshness,
+                            DescriptionCallback done);
+
+/// Same as above, with the description delivered through a future.
+std::future<std::optional<CveDescription>> getCveDescriptionAsync(CveId cveId,
+                                                                  Fetcher& fetcher,
+                                                                  Store& store,
+                                                                  const utils::Freshness& freshness);
+
+/// Fetches @p cveId into @p store, unless another process is refreshing it already. Run by the background
+/// process of getCveDescription().
+bool refreshCveDescription(CveId cveId, const std::optional<std::string>& apiKey, Store& store);
 
 } // namespace cveinfo::nist
 
@@ -0,0 +1,51 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVE_SCHEMA_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVE_SCHEMA_HPP_
+
+#include "cveinfo/utils/json.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/// Fields read from the NVD and debian security tracker documents, parsed at compile time.
+
+namespace cveinfo::nist::schema {
+
+/// Response of the CVE API 2.0, https://nvd.nist.gov/developers/vulnerabilities
+inline constexpr utils::JsonField<std::size_t> TOTAL_RESULTS("/totalResults");
+inline constexpr utils::JsonPointer VULNERABILITIES("/vulnerabilities");
+/// The CVE record of a response to a single CVE ID
+inline constexpr utils::JsonPointer FIRST_CVE("/vulnerabilities/0/cve");
+
+/// The CVE record of an element of VULNERABILITIES
+inline constexpr utils::JsonPointer CVE("/cve");
+
+/// CVE record
+inline constexpr utils::JsonField<std::string> ID("/id");
+inline constexpr utils::JsonPointer CVSS_V31("/metrics/cvssMetricV31/0/cvssData");
+inline constexpr utils::JsonPointer DESCRIPTIONS("/descriptions");
+
+/// CVSS data of a CVSS_V31 metric
+inline constexpr utils::JsonField<std::string> VECTOR_STRING("/vectorString");
+inline constexpr utils::JsonField<std::string> BASE_SEVERITY("/baseSeverity");
+inline constexpr utils::JsonField<float> BASE_SCORE("/baseScore");
+
+/// Element of DESCRIPTIONS
+inline constexpr utils::JsonField<std::string> LANG("/lang");
+inline constexpr utils::JsonField<std::string> VALUE("/value");
+
+} // namespace cveinfo::nist::schema
+
+namespace cveinfo::debian::schema {
+
+/// Members of a CVE of a package in the tracker document, {package: {CVE ID: {...}}}, streamed by
+/// TrackerParser
+inline constexpr std::string_view RELEASES = "releases";
+
+/// Members of a release, keyed by codename under RELEASES
+inline constexpr std::string_view STATUS = "status";
+inline constexpr std::string_view FIXED_VERSION = "fixed_version";
+
+} // namespace cveinfo::debian::schema
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVE_SCHEMA_HPP_
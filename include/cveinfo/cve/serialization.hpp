@@ -0,0 +1,23 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVE_SERIALIZATION_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_CVE_SERIALIZATION_HPP_
+
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/nist.hpp"
+
+#include <nlohmann/json.hpp>
+
+namespace cveinfo::nist {
+
+void to_json(nlohmann::json& j, const CveDescription& description);
+void from_json(const nlohmann::json& j, CveDescription& description);
+
+} // namespace cveinfo::nist
+
+namespace cveinfo::debian {
+
+void to_json(nlohmann::json& j, const CodenameInfo& info);
+void to_json(nlohmann::json& j, const TrackerInfo& info);
+
+} // namespace cveinfo::debian
+
+#endif // CVEINFO_INCLUDE_CVEINFO_CVE_SERIALIZATION_HPP_
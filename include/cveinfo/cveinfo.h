@@ -0,0 +1,57 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_CVEINFO_H_
+#define CVEINFO_INCLUDE_CVEINFO_CVEINFO_H_
+
+#include "cveinfo/export.h"
+
+/*
+ * C interface of libcveinfo, for bindings (cgo, ctypes, ...) to cveinfo::Context.
+ *
+ * Results are the JSON objects of batch mode, as NUL terminated UTF-8 strings. No C++ exception crosses
+ * this interface.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cveinfo_context cveinfo_context;
+
+/* Called with a result that is only valid during the call, see cveinfo::Context::query() */
+typedef void (*cveinfo_callback)(const char* result, void* user_data);
+
+/*
+ * Creates a context, loading the debian security tracker. @p options is a JSON object with any of the
+ * members "codename", "apiKey", "jobs", "cacheSize" (MiB), "noCvss" and the durations (e.g. "30m")
+ * "trackerMaxAge", "trackerMaxStale", "nvdMaxAge" and "nvdMaxStale"; NULL keeps the defaults.
+ *
+ * Returns NULL on failure, the reason is logged to stderr.
+ */
+CVEINFO_EXPORT cveinfo_context* cveinfo_open(const char* options);
+
+/* Waits for the queries in flight and frees @p context */
+CVEINFO_EXPORT void cveinfo_close(cveinfo_context* context);
+
+/*
+ * Queues a lookup of @p cve_id, restricted to the debian package @p package_name unless NULL. @p done is
+ * called with the result from the calling thread or from a worker thread.
+ *
+ * Returns 0 if queued, -1 otherwise in which case @p done is not called.
+ */
+CVEINFO_EXPORT int cveinfo_query(cveinfo_context* context,
+                                 const char* cve_id,
+                                 const char* package_name,
+                                 cveinfo_callback done,
+                                 void* user_data);
+
+/* Looks @p cve_id up and waits for the result, to be freed with cveinfo_free(). Returns NULL on failure */
+CVEINFO_EXPORT char* cveinfo_query_sync(cveinfo_context* context,
+                                        const char* cve_id,
+                                        const char* package_name);
+
+CVEINFO_EXPORT void cveinfo_free(char* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CVEINFO_INCLUDE_CVEINFO_CVEINFO_H_ */
@@ -0,0 +1,61 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_ENDPOINTS_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_ENDPOINTS_HPP_
+
+#include <cstddef>
+#include <cstdlib>
+#include <optional>
+#include <string>
+
+/// Services cveinfo talks to. They can be pointed elsewhere, e.g. at a local mock server for load tests,
+/// through environment variables. Being environment variables, the overrides also apply to the
+/// background refresh processes.
+namespace cveinfo::endpoints {
+
+constexpr auto NVD_URL_ENV = "CVEINFO_NVD_URL";
+constexpr auto TRACKER_URL_ENV = "CVEINFO_TRACKER_URL";
+constexpr auto NVD_RATE_LIMIT_ENV = "CVEINFO_NVD_RATE_LIMIT";
+constexpr auto CA_BUNDLE_ENV = "CVEINFO_CA_BUNDLE";
+constexpr auto NVD_API_KEY_ENV = "CVEINFO_NVD_API_KEY";
+
+constexpr auto DEFAULT_NVD_URL = "https://services.nvd.nist.gov/rest/json/cves/2.0";
+constexpr auto DEFAULT_TRACKER_URL = "https://security-tracker.debian.org/tracker/data/json";
+
+/// URL of the NVD CVE API.
+inline std::string nvdUrl() {
+    const char* url = getenv(NVD_URL_ENV);
+    return url && *url ? url : DEFAULT_NVD_URL;
+}
+
+/// URL of the debian security tracker JSON dump.
+inline std::string trackerUrl() {
+    const char* url = getenv(TRACKER_URL_ENV);
+    return url && *url ? url : DEFAULT_TRACKER_URL;
+}
+
+/// Number of NVD requests allowed per rate limit window, std::nullopt to follow the published NVD limits.
+inline std::optional<std::size_t> nvdRateLimit() {
+    const char* limit = getenv(NVD_RATE_LIMIT_ENV);
+    if (!limit) {
+        return std::nullopt;
+    }
+    const auto value = std::strtoull(limit, nullptr, 10);
+    return value > 0 ? std::optional<std::size_t>(value) : std::nullopt;
+}
+
+/// File of the CA certificates the services are verified with, std::nullopt for the system ones (e.g. for a
+/// mirror behind a TLS intercepting proxy).
+inline std::optional<std::string> caBundle() {
+    const char* path = getenv(CA_BUNDLE_ENV);
+    return path && *path ? std::optional<std::string>(path) : std::nullopt;
+}
+
+/// API key of the NVD, std::nullopt to use the lower public rate limits. Background refresh processes get
+/// it through their environment rather than their command line, which any user can read.
+inline std::optional<std::string> nvdApiKey() {
+    const char* key = getenv(NVD_API_KEY_ENV);
+    return key && *key ? std::optional<std::string>(key) : std::nullopt;
+}
+
+} // namespace cveinfo::endpoints
+
+#endif // CVEINFO_INCLUDE_CVEINFO_ENDPOINTS_HPP_
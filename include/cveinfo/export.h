@@ -0,0 +1,7 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_EXPORT_H_
+#define CVEINFO_INCLUDE_CVEINFO_EXPORT_H_
+
+/* Everything is built with hidden visibility, only the embedding API is exported by the shared library */
+#define CVEINFO_EXPORT __attribute__((visibility("default")))
+
+#endif /* CVEINFO_INCLUDE_CVEINFO_EXPORT_H_ */
@@ -0,0 +1,37 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_HTTP_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_HTTP_HPP_
+
+#include <cpr/cpr.h>
+
+#include <cstddef>
+#include <string>
+
+/// HTTP client shared by all the requests to the NVD and the debian security tracker.
+///
+/// Requests go through sessions pooled per host, which keep their connection open between requests, so
+/// consecutive requests to a host skip the TCP and TLS handshakes. TLS sessions and DNS lookups are shared
+/// by all sessions, a new connection to a known host resumes the TLS session instead of doing a full
+/// handshake. Certificates are verified against the system CAs or endpoints::caBundle(), HTTP/2 is
+/// negotiated over TLS where the server supports it and responses are requested compressed.
+namespace cveinfo::http {
+
+struct Stats {
+    /// Connections opened, each with a TCP and possibly a TLS handshake
+    std::size_t opened = 0;
+    /// Requests sent on a connection left open by a previous request
+    std::size_t reused = 0;
+};
+
+/// Sends a GET request of @p url through a pooled session of its host.
+cpr::Response get(const std::string& url, const cpr::Header& header = {});
+
+/// Sends a GET request of @p url, streaming the response body to @p onData instead of keeping it in the
+/// response. Meant for large one-off downloads, the session isn't pooled.
+cpr::Response download(const std::string& url, const cpr::Header& header, const cpr::WriteCallback& onData);
+
+/// Connections of all the requests sent so far.
+Stats stats();
+
+} // namespace cveinfo::http
+
+#endif // CVEINFO_INCLUDE_CVEINFO_HTTP_HPP_
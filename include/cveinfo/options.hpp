@@ -0,0 +1,31 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_OPTIONS_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_OPTIONS_HPP_
+
+#include "cveinfo/utils/utils.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace cveinfo {
+
+/// Command line options shared by all the lookup modes.
+struct Options {
+    bool noCvss = false;
+    std::optional<std::string> codename;
+    /// Only releases with this debian tracker status are listed by package queries
+    std::optional<std::string> status;
+    std::optional<std::string> apiKey;
+    /// Number of concurrent NVD requests in bulk lookups
+    std::size_t jobs = 8;
+    /// Size limit of the NVD cache in bytes
+    std::uint64_t cacheSize = 256 * 1024 * 1024;
+    utils::Freshness trackerFreshness{ std::chrono::hours(1), std::chrono::days(1) };
+    utils::Freshness nvdFreshness{ std::chrono::hours(1), std::chrono::days(7) };
+};
+
+} // namespace cveinfo
+
+#endif // CVEINFO_INCLUDE_CVEINFO_OPTIONS_HPP_
@@ -0,0 +1,20 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_PACKAGE_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_PACKAGE_HPP_
+
+#include "cveinfo/options.hpp"
+
+#include <ostream>
+#include <string>
+
+namespace cveinfo::package {
+
+/// Streams every CVE affecting the debian package @p packageName to @p output as newline delimited JSON,
+/// ordered by CVE ID.
+///
+/// Releases are filtered by the codename and status of @p options. The NVD severity and score are joined
+/// from the local NVD cache only, CVEs missing there are listed without them; `--sync` fills the cache.
+int run(const std::string& packageName, std::ostream& output, const Options& options);
+
+} // namespace cveinfo::package
+
+#endif // CVEINFO_INCLUDE_CVEINFO_PACKAGE_HPP_
@@ -0,0 +1,112 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_PROFILE_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_PROFILE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+/// Built-in profiling of the lookup phases.
+///
+/// Counters are plain relaxed atomics and always collected, so long-running modes can export them at any
+/// time. Phase timers only cost a relaxed load unless profiling is enabled; they then aggregate the time
+/// spent per phase and, if a trace was requested, record every phase as a Chrome trace event.
+namespace cveinfo::profile {
+
+enum class Counter {
+    HTTP_REQUESTS,
+    BYTES_DOWNLOADED,
+    RATE_LIMITED,
+    RETRIES,
+    HTTP_CONNECTIONS_OPENED,
+    HTTP_CONNECTIONS_REUSED,
+    CACHE_HITS,
+    CACHE_MISSES,
+    CACHE_STALE,
+    PACKAGES_SCANNED,
+    COMPONENTS_SCANNED,
+    QUERIES,
+    COUNT,
+};
+
+namespace detail {
+
+extern std::atomic<bool> gEnabled;
+extern std::atomic<std::uint64_t> gCounters[static_cast<std::size_t>(Counter::COUNT)];
+
+} // namespace detail
+
+inline bool enabled() {
+    return detail::gEnabled.load(std::memory_order_relaxed);
+}
+
+inline void add(Counter counter, std::uint64_t value = 1) {
+    detail::gCounters[static_cast<std::size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+inline std::uint64_t value(Counter counter) {
+    return detail::gCounters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+/// Records @p phase as having taken from @p start until now, for spans not matching a block.
+void record(const char* phase, std::chrono::steady_clock::time_point start);
+
+/// Times the enclosing block as @p phase, which has to be a string literal.
+class Scope {
+public:
+    explicit Scope(const char* phase)
+        : mPhase(enabled() ? phase : nullptr) {
+        if (mPhase) {
+            mStart = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~Scope() {
+        if (mPhase) {
+            record(mPhase, mStart);
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* mPhase;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+/// Enables the phase timers, recording trace events as well if @p trace is set.
+void enable(bool trace);
+
+/// Prints the time spent per phase and the counters to stderr.
+void printSummary();
+
+/// Writes the recorded phases and the final counter values as Chrome trace-event JSON, viewable in
+/// chrome://tracing or Perfetto.
+bool writeTrace(const std::filesystem::path& path);
+
+/// Returns the counters, the peak RSS and the phase timings in the Prometheus text format.
+std::string prometheus();
+
+/// Reports the profile of the run once it goes out of scope, on whichever path main() returns.
+class Report {
+public:
+    Report(bool summary,
+           std::optional<std::filesystem::path> traceFile,
+           std::optional<std::filesystem::path> metricsFile);
+    ~Report();
+
+    Report(const Report&) = delete;
+    Report& operator=(const Report&) = delete;
+
+private:
+    const bool mSummary;
+    const std::optional<std::filesystem::path> mTraceFile;
+    const std::optional<std::filesystem::path> mMetricsFile;
+};
+
+} // namespace cveinfo::profile
+
+#endif // CVEINFO_INCLUDE_CVEINFO_PROFILE_HPP_
@@ -0,0 +1,45 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_REFRESH_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_REFRESH_HPP_
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cveinfo::refresh {
+
+/// Exclusive right to refresh a cached copy, shared by all cveinfo processes using the same cache directory.
+///
+/// Leases are byte-range locks of a lock file, so one file can hold independent leases, e.g. one per CVE.
+/// They are released when the Lease is destroyed or the process dies.
+class Lease {
+public:
+    /// Waits until the lease is available.
+    static Lease acquire(const std::filesystem::path& lockPath, std::uint64_t slot = 0);
+
+    /// Returns std::nullopt right away if someone else holds the lease.
+    static std::optional<Lease> tryAcquire(const std::filesystem::path& lockPath, std::uint64_t slot = 0);
+
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&&) = delete;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+private:
+    explicit Lease(int fd)
+        : mFd(fd) {}
+
+    int mFd;
+};
+
+/// Runs cveinfo with @p arguments in a detached background process and returns right away.
+///
+/// The background process inherits the environment, with the "NAME=value" entries of @p environment added
+/// or replaced. Its output is appended to refresh.log in the cache directory.
+void spawn(const std::vector<std::string>& arguments, std::vector<std::string> environment = {});
+
+} // namespace cveinfo::refresh
+
+#endif // CVEINFO_INCLUDE_CVEINFO_REFRESH_HPP_
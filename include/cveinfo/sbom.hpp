@@ -0,0 +1,52 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_SBOM_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_SBOM_HPP_
+
+#include "cveinfo/options.hpp"
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/// Scans of software bills of materials (CycloneDX and SPDX JSON documents) against the debian security
+/// tracker and the NVD cache.
+namespace cveinfo::sbom {
+
+/// Component of a CycloneDX document or package of an SPDX document, with the fields used for matching.
+struct Component {
+    std::string name;
+    std::string version;
+    /// Package URL, e.g. pkg:deb/debian/libssl3@3.0.11-1~deb12u2?arch=amd64&distro=debian-12
+    std::optional<std::string> purl;
+    /// CPE 2.3 name
+    std::optional<std::string> cpe;
+};
+
+/// Called with each component as soon as it's parsed, returns false to stop parsing.
+using ComponentCallback = std::function<bool(Component&& component)>;
+
+/// Streams the components of the CycloneDX or SPDX JSON document @p document to @p onComponent, in document
+/// order except for nested components, which come before the component containing them.
+///
+/// Only the component fields are extracted, the document is never held as a whole in memory. Returns false
+/// if @p onComponent stopped the parsing, throws std::runtime_error on malformed documents.
+bool parse(std::string_view document, const ComponentCallback& onComponent);
+
+/// Matches the components of the SBOM @p sbomPath against the debian security tracker and streams the CVEs
+/// fixed in a newer version than the component's to @p output as newline delimited JSON, one object per
+/// component and CVE.
+///
+/// Debian packages are identified by their pkg:deb package URL, and resolved to the source package they're
+/// built from. Components without a package URL are matched by the product of their CPE name when it's a
+/// source package of the tracker, comparing upstream versions only.
+///
+/// The debian release is the codename of @p options, or the one of the distro qualifier of the package
+/// URLs. The SBOM is scanned in chunks of components: each chunk is matched on all cores, the NVD records of
+/// its CVEs are looked up together and its results written before the next chunk is parsed.
+int run(const std::filesystem::path& sbomPath, std::ostream& output, const Options& options);
+
+} // namespace cveinfo::sbom
+
+#endif // CVEINFO_INCLUDE_CVEINFO_SBOM_HPP_
@@ -0,0 +1,21 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_SCAN_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_SCAN_HPP_
+
+#include "cveinfo/options.hpp"
+
+#include <filesystem>
+#include <ostream>
+
+namespace cveinfo::scan {
+
+/// Matches every package installed according to the dpkg status file @p statusPath against the debian
+/// security tracker and streams the CVEs fixed in a newer version than the installed one to @p output as
+/// newline delimited JSON, one object per source package and CVE.
+///
+/// The debian release is the codename of @p options, or the one of the scanned system's os-release file
+/// (found relative to @p statusPath, so status files of unpacked images work too).
+int run(const std::filesystem::path& statusPath, std::ostream& output, const Options& options);
+
+} // namespace cveinfo::scan
+
+#endif // CVEINFO_INCLUDE_CVEINFO_SCAN_HPP_
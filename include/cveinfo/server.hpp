@@ -0,0 +1,21 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_SERVER_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_SERVER_HPP_
+
+#include "cveinfo/options.hpp"
+
+#include <filesystem>
+
+namespace cveinfo::server {
+
+/// Serves lookups over the Unix domain socket @p socketPath until SIGINT or SIGTERM.
+///
+/// Clients send "<CVE ID> [package-name]" lines like in batch mode and get a JSON line back for each of
+/// them. The debian security tracker is loaded once and refreshed in the background; the refreshed tracker
+/// replaces the current one atomically while queries in flight keep using the one they started with.
+/// A "metrics" line is answered with the profiling counters in the Prometheus text format, ending with a
+/// "# EOF" line.
+int run(const std::filesystem::path& socketPath, const Options& options);
+
+} // namespace cveinfo::server
+
+#endif // CVEINFO_INCLUDE_CVEINFO_SERVER_HPP_
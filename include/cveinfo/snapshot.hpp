@@ -0,0 +1,26 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_SNAPSHOT_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_SNAPSHOT_HPP_
+
+#include "cveinfo/options.hpp"
+
+#include <filesystem>
+
+/// Snapshot bundles of the local databases, to refresh them once and ship them to many (possibly offline)
+/// machines.
+///
+/// A bundle holds the debian tracker database with its metadata and indexes and the NVD cache, each file
+/// compressed as one zstd frame with a content checksum. The files are stored in their on-disk formats, so
+/// importing a bundle is decompressing it next to the databases and moving the files into place; nothing
+/// is parsed or indexed again.
+namespace cveinfo::snapshot {
+
+/// Writes a bundle of the current databases to @p path.
+int exportTo(const std::filesystem::path& path, const Options& options);
+
+/// Replaces the local databases with the ones of the bundle @p path, keeping their modification and
+/// download times so they're as fresh as they were when exported.
+int importFrom(const std::filesystem::path& path, const Options& options);
+
+} // namespace cveinfo::snapshot
+
+#endif // CVEINFO_INCLUDE_CVEINFO_SNAPSHOT_HPP_
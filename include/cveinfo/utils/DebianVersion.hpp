@@ -0,0 +1,139 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_UTILS_DEBIANVERSION_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_UTILS_DEBIANVERSION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace cveinfo::utils {
+
+/// Debian package version split into its "[epoch:]upstream[-revision]" parts, viewing the parsed string.
+struct DebianVersion {
+    std::uint64_t epoch = 0;
+    std::string_view upstream;
+    std::string_view revision;
+
+    static constexpr DebianVersion parse(std::string_view version) {
+        DebianVersion parsed;
+        if (const auto colon = version.find(':'); colon != std::string_view::npos) {
+            for (const char c : version.substr(0, colon)) {
+                if (c >= '0' && c <= '9') {
+                    parsed.epoch = parsed.epoch * 10 + static_cast<std::uint64_t>(c - '0');
+                }
+            }
+            version.remove_prefix(colon + 1);
+        }
+        // The upstream version may contain hyphens itself, only the last one starts the revision
+        if (const auto hyphen = version.rfind('-'); hyphen != std::string_view::npos) {
+            parsed.revision = version.substr(hyphen + 1);
+            version = version.substr(0, hyphen);
+        }
+        parsed.upstream = version;
+        return parsed;
+    }
+};
+
+namespace detail {
+
+constexpr bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool isAlpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/// Sort weight of a non-digit character: '~' sorts before anything, even the end of the string, letters
+/// sort before the other characters.
+constexpr int order(std::string_view str, std::size_t i) {
+    if (i >= str.size()) {
+        return 0;
+    }
+    const char c = str[i];
+    if (isDigit(c)) {
+        return 0;
+    }
+    if (isAlpha(c)) {
+        return c;
+    }
+    if (c == '~') {
+        return -1;
+    }
+    return static_cast<unsigned char>(c) + 256;
+}
+
+/// Compares upstream versions or revisions like dpkg: alternating non-digit parts compared with order()
+/// and digit parts compared numerically.
+constexpr int compareFragment(std::string_view lhs, std::string_view rhs) {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < lhs.size() || j < rhs.size()) {
+        while ((i < lhs.size() && !isDigit(lhs[i])) || (j < rhs.size() && !isDigit(rhs[j]))) {
+            const int l = order(lhs, i);
+            const int r = order(rhs, j);
+            if (l != r) {
+                return l < r ? -1 : 1;
+            }
+            ++i;
+            ++j;
+        }
+        while (i < lhs.size() && lhs[i] == '0') {
+            ++i;
+        }
+        while (j < rhs.size() && rhs[j] == '0') {
+            ++j;
+        }
+        int firstDifference = 0;
+        while (i < lhs.size() && isDigit(lhs[i]) && j < rhs.size() && isDigit(rhs[j])) {
+            if (firstDifference == 0 && lhs[i] != rhs[j]) {
+                firstDifference = lhs[i] < rhs[j] ? -1 : 1;
+            }
+            ++i;
+            ++j;
+        }
+        // The longer number is the bigger one
+        if (i < lhs.size() && isDigit(lhs[i])) {
+            return 1;
+        }
+        if (j < rhs.size() && isDigit(rhs[j])) {
+            return -1;
+        }
+        if (firstDifference != 0) {
+            return firstDifference;
+        }
+    }
+    return 0;
+}
+
+} // namespace detail
+
+/// Compares two Debian package versions following the dpkg rules, without allocating.
+///
+/// Returns a negative number if @p lhs is older than @p rhs, zero if they're equal and a positive number
+/// if @p lhs is newer.
+constexpr int compareVersions(std::string_view lhs, std::string_view rhs) {
+    const auto l = DebianVersion::parse(lhs);
+    const auto r = DebianVersion::parse(rhs);
+    if (l.epoch != r.epoch) {
+        return l.epoch < r.epoch ? -1 : 1;
+    }
+    if (const int upstream = detail::compareFragment(l.upstream, r.upstream); upstream != 0) {
+        return upstream;
+    }
+    return detail::compareFragment(l.revision, r.revision);
+}
+
+static_assert(DebianVersion::parse("1:1.2-3-4").epoch == 1);
+static_assert(DebianVersion::parse("1:1.2-3-4").upstream == "1.2-3");
+static_assert(DebianVersion::parse("1:1.2-3-4").revision == "4");
+static_assert(compareVersions("1:1.0", "2.0") > 0 && compareVersions("0:2.0", "2.0") == 0);
+static_assert(compareVersions("1.0~rc1", "1.0") < 0 && compareVersions("1.0~~", "1.0~") < 0);
+static_assert(compareVersions("1.0~rc1", "1.0~rc2") < 0 && compareVersions("1.0", "1.0+b1") < 0);
+static_assert(compareVersions("1.01", "1.1") == 0 && compareVersions("1.10", "1.9") > 0);
+static_assert(compareVersions("1.0a", "1.0+") < 0 && compareVersions("1.0", "1.0a") < 0);
+static_assert(compareVersions("1.2-3-4", "1.2-3-5") < 0 && compareVersions("1.2-3-4", "1.2-4") > 0);
+static_assert(compareVersions("1.0", "1.0-0") == 0 && compareVersions("1.0", "1.0-1") < 0);
+
+} // namespace cveinfo::utils
+
+#endif // CVEINFO_INCLUDE_CVEINFO_UTILS_DEBIANVERSION_HPP_
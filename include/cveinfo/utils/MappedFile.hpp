@@ -0,0 +1,93 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_UTILS_MAPPEDFILE_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_UTILS_MAPPEDFILE_HPP_
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cveinfo::utils {
+
+/// Memory mapping of a whole file.
+class MappedFile {
+public:
+    enum class Mode {
+        READ_ONLY,
+        /// Changes are written back to the file
+        READ_WRITE,
+    };
+
+    explicit MappedFile(const std::filesystem::path& path, Mode mode = Mode::READ_ONLY) {
+        const bool writable = mode == Mode::READ_WRITE;
+        const int fd = ::open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error{ std::error_code{ errno, std::system_category() }, path };
+        }
+        struct stat buf;
+        if (fstat(fd, &buf) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error{ std::error_code{ error, std::system_category() }, path };
+        }
+        mSize = static_cast<std::size_t>(buf.st_size);
+        if (mSize > 0) {
+            mData = mmap(nullptr,
+                         mSize,
+                         writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                         writable ? MAP_SHARED : MAP_PRIVATE,
+                         fd,
+                         0);
+            if (mData == MAP_FAILED) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error{ std::error_code{ error, std::system_category() }, path };
+            }
+        }
+        ::close(fd);
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : mData(std::exchange(other.mData, nullptr))
+        , mSize(std::exchange(other.mSize, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            mData = std::exchange(other.mData, nullptr);
+            mSize = std::exchange(other.mSize, 0);
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { unmap(); }
+
+    const char* data() const { return static_cast<const char*>(mData); }
+    char* data() { return static_cast<char*>(mData); }
+    std::size_t size() const { return mSize; }
+    std::string_view view() const { return { data(), mSize }; }
+
+private:
+    void unmap() {
+        if (mData) {
+            munmap(mData, mSize);
+            mData = nullptr;
+        }
+    }
+
+    void* mData = nullptr;
+    std::size_t mSize = 0;
+};
+
+} // namespace cveinfo::utils
+
+#endif // CVEINFO_INCLUDE_CVEINFO_UTILS_MAPPEDFILE_HPP_
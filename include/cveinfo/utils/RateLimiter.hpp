@@ -0,0 +1,45 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_UTILS_RATELIMITER_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_UTILS_RATELIMITER_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cveinfo::utils {
+
+/// Thread-safe limiter allowing at most @p limit events in any rolling window of @p period.
+///
+/// Keeps a ring of the last @p limit event times: an event waits until the oldest of them has left the
+/// window, so unlike a token bucket it never lets a burst and the refill that follows it share a window.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    RateLimiter(std::size_t limit, Clock::duration period)
+        : mPeriod(period)
+        , mTimes(std::max<std::size_t>(limit, 1), Clock::now() - period) {}
+
+    /// Blocks until an event is allowed and records it as happening now.
+    ///
+    /// Waiting callers are let through one at a time, each event is recorded when it's let through rather
+    /// than when it was scheduled, so a late wake-up can't squeeze an extra event into the window.
+    void acquire() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::this_thread::sleep_until(mTimes[mOldest] + mPeriod);
+        mTimes[mOldest] = Clock::now();
+        mOldest = (mOldest + 1) % mTimes.size();
+    }
+
+private:
+    std::mutex mMutex;
+    const Clock::duration mPeriod;
+    std::vector<Clock::time_point> mTimes;
+    std::size_t mOldest = 0;
+};
+
+} // namespace cveinfo::utils
+
+#endif // CVEINFO_INCLUDE_CVEINFO_UTILS_RATELIMITER_HPP_
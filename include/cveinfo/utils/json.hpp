@@ -3,19 +3,167 @@
 
 #include <nlohmann/json.hpp>
 
+#include <array>
+#include <cstddef>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace cveinfo::utils {
 
+/// A JSON pointer (RFC 6901) split into its reference tokens once, at compile time when it's a constant.
+///
+/// Looking it up never throws: a missing member, an out of range index or a value of the wrong kind on
+/// the way just yield nullptr. The escapes ~0 and ~1 aren't supported, no field of the documents read
+/// needs them; a constant using them, or having more than MAX_TOKENS tokens, doesn't compile and any other
+/// malformed pointer never matches.
+class JsonPointer {
+public:
+    static constexpr std::size_t MAX_TOKENS = 8;
+
+    constexpr JsonPointer(std::string_view pointer) {
+        if (!pointer.empty() && pointer.front() != '/') {
+            invalid("a JSON pointer has to start with '/'");
+            return;
+        }
+        while (!pointer.empty()) {
+            pointer.remove_prefix(1);
+            const auto end = pointer.find('/');
+            const auto token = pointer.substr(0, end);
+            if (token.find('~') != std::string_view::npos) {
+                invalid("escaped JSON pointer tokens aren't supported");
+                return;
+            }
+            if (mSize == MAX_TOKENS) {
+                invalid("too many JSON pointer tokens");
+                return;
+            }
+            mTokens[mSize++] = Token{ token, indexOf(token) };
+            pointer.remove_prefix(end == std::string_view::npos ? pointer.size() : end);
+        }
+    }
+
+    constexpr JsonPointer(const char* pointer)
+        : JsonPointer(std::string_view(pointer)) {}
+
+    /// Returns the value the pointer refers to in @p object, nullptr if there's none.
+    const nlohmann::json* find(const nlohmann::json& object) const {
+        if (!mValid) {
+            return nullptr;
+        }
+        const nlohmann::json* value = &object;
+        for (std::size_t i = 0; i < mSize; ++i) {
+            const auto& token = mTokens[i];
+            if (value->is_object()) {
+                const auto it = value->find(token.name);
+                if (it == value->end()) {
+                    return nullptr;
+                }
+                value = &*it;
+            } else if (value->is_array() && token.index < value->size()) {
+                value = &(*value)[token.index];
+            } else {
+                return nullptr;
+            }
+        }
+        return value;
+    }
+
+private:
+    static constexpr std::size_t NOT_AN_INDEX = static_cast<std::size_t>(-1);
+
+    struct Token {
+        std::string_view name;
+        /// Array index the token stands for, NOT_AN_INDEX if it isn't a valid one
+        std::size_t index = NOT_AN_INDEX;
+    };
+
+    static constexpr std::size_t indexOf(std::string_view token) {
+        // Leading zeros aren't allowed, "-" (past the end) never refers to an existing element
+        if (token.empty() || (token.size() > 1 && token.front() == '0')) {
+            return NOT_AN_INDEX;
+        }
+        std::size_t index = 0;
+        for (const char c : token) {
+            if (c < '0' || c > '9' || index > (NOT_AN_INDEX - 9) / 10) {
+                return NOT_AN_INDEX;
+            }
+            index = index * 10 + static_cast<std::size_t>(c - '0');
+        }
+        return index;
+    }
+
+    constexpr void invalid(const char* reason) {
+        if (std::is_constant_evaluated()) {
+            // Not a constant expression, so a malformed constant pointer is a compile error
+            throw reason;
+        }
+        mValid = false;
+    }
+
+    std::array<Token, MAX_TOKENS> mTokens{};
+    std::size_t mSize = 0;
+    bool mValid = true;
+};
+
+/// Converts @p value to T if it's of a matching kind, without throwing.
+///
+/// Integers only convert from JSON integers (unsigned ones from non-negative integers), floating point
+/// numbers from any number.
 template <typename T>
-static std::optional<T> getAs(const nlohmann::json& object, const std::string& path) {
-    try {
-        return object.at(nlohmann::json::json_pointer(path)).get<T>();
-    } catch (...) {
+std::optional<T> valueAs(const nlohmann::json& value) {
+    if constexpr (std::is_same_v<T, nlohmann::json>) {
+        return value;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        if (value.is_string()) {
+            return value.get_ref<const std::string&>();
+        }
+    } else if constexpr (std::is_same_v<T, bool>) {
+        if (value.is_boolean()) {
+            return value.get<bool>();
+        }
+    } else if constexpr (std::is_integral_v<T>) {
+        if (std::is_unsigned_v<T> ? value.is_number_unsigned() : value.is_number_integer()) {
+            return value.get<T>();
+        }
+    } else {
+        static_assert(std::is_floating_point_v<T>, "unsupported JSON field type");
+        if (value.is_number()) {
+            return value.get<T>();
+        }
     }
     return std::nullopt;
 }
 
+/// A field of type T of a JSON record, the entries of the record schemas.
+template <typename T>
+class JsonField {
+public:
+    constexpr JsonField(std::string_view pointer)
+        : mPointer(pointer) {}
+
+    /// Returns the field of @p record, std::nullopt if it's missing or isn't a T.
+    std::optional<T> operator()(const nlohmann::json& record) const {
+        const auto* value = mPointer.find(record);
+        return value ? valueAs<T>(*value) : std::nullopt;
+    }
+
+    constexpr const JsonPointer& pointer() const { return mPointer; }
+
+private:
+    JsonPointer mPointer;
+};
+
+/// Returns the value at @p path in @p object as T, std::nullopt if it's missing or of another kind.
+///
+/// @p path is parsed at each call, prefer a constant JsonField for the fields read repeatedly.
+template <typename T>
+std::optional<T> getAs(const nlohmann::json& object, std::string_view path) {
+    const auto* value = JsonPointer(path).find(object);
+    return value ? valueAs<T>(*value) : std::nullopt;
+}
+
 } // namespace cveinfo::utils
 
 #endif // CVEINFO_INCLUDE_CVEINFO_UTILS_JSON_HPP_
@@ -10,6 +10,7 @@
 #include <limits>
 #include <optional>
 #include <string>
+#include <sys/resource.h>
 #include <sys/stat.h>
 
 namespace cveinfo::utils {
@@ -42,12 +43,66 @@ inline std::chrono::system_clock::time_point lastWriteTime(const std::filesystem
     return std::chrono::system_clock::from_time_t(time_t(buf.st_mtim.tv_sec));
 }
 
+/// Returns the peak resident set size of the current process in bytes.
+inline std::size_t peakResidentSetSize() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+}
+
 template <typename TRep, typename TPeriod>
 inline bool isOlderThan(const std::filesystem::path& p,
                         const std::chrono::duration<TRep, TPeriod>& duration) {
     return std::chrono::system_clock::now() - utils::lastWriteTime(p) > duration;
 }
 
+/// How long a cached copy may be used: it's fresh up to maxAge, then it's still answered from while it's
+/// refreshed in the background up to maxStale. Older copies are refreshed before they're used.
+struct Freshness {
+    enum class State {
+        FRESH,
+        STALE,
+        EXPIRED,
+    };
+
+    std::chrono::seconds maxAge;
+    std::chrono::seconds maxStale;
+
+    /// @p age is std::nullopt if there's no cached copy at all
+    template <typename TRep, typename TPeriod>
+    State of(const std::optional<std::chrono::duration<TRep, TPeriod>>& age) const {
+        if (!age || *age > maxStale) {
+            return State::EXPIRED;
+        }
+        return *age > maxAge ? State::STALE : State::FRESH;
+    }
+};
+
+/// Parses durations like "90", "30s", "15m", "2h" or "7d", plain numbers are seconds.
+inline std::optional<std::chrono::seconds> parseDuration(const std::string& str) {
+    char* end = nullptr;
+    const auto value = std::strtoll(str.c_str(), &end, 10);
+    if (end == str.c_str() || value < 0) {
+        return std::nullopt;
+    }
+    const std::string unit(end);
+    if (unit.empty() || unit == "s") {
+        return std::chrono::seconds(value);
+    }
+    if (unit == "m") {
+        return std::chrono::minutes(value);
+    }
+    if (unit == "h") {
+        return std::chrono::hours(value);
+    }
+    if (unit == "d") {
+        return std::chrono::days(value);
+    }
+    return std::nullopt;
+}
+
 struct OlderThan {
     template <typename TRep, typename TPeriod>
     OlderThan(const std::chrono::duration<TRep, TPeriod>& d)
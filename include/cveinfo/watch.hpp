@@ -0,0 +1,26 @@
+#ifndef CVEINFO_INCLUDE_CVEINFO_WATCH_HPP_
+#define CVEINFO_INCLUDE_CVEINFO_WATCH_HPP_
+
+#include "cveinfo/options.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <ostream>
+
+namespace cveinfo::watch {
+
+/// Keeps the databases fresh and streams the changes affecting the debian source packages listed in
+/// @p watchlist (one per line, # starts a comment) to @p output as newline delimited JSON.
+///
+/// Every @p interval, the tracker and the NVD records of the CVEs of the watched packages are refreshed
+/// if they went stale, and the change feed is read. Tracker changes are matched by package, NVD score
+/// changes by the CVEs the tracker lists for the watched packages. Changes published by other processes,
+/// e.g. background refreshes, are reported as well. Runs until interrupted or the output fails.
+int run(const std::filesystem::path& watchlist,
+        std::chrono::seconds interval,
+        std::ostream& output,
+        const Options& options);
+
+} // namespace cveinfo::watch
+
+#endif // CVEINFO_INCLUDE_CVEINFO_WATCH_HPP_
@@ -0,0 +1,131 @@
+#include "cveinfo/Context.hpp"
+
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/NistFetcher.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/nist.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+struct Context::Impl {
+    explicit Impl(Options options)
+        : options(std::move(options))
+        // Refreshed in the foreground, library code doesn't start processes: in an embedding service, the
+        // background refresh would run the host executable
+        , tracker(std::make_shared<const debian::DebianSecurityTracker>(
+              this->options.codename,
+              this->options.trackerFreshness,
+              debian::DebianSecurityTracker::RefreshMode::FOREGROUND))
+        , store(nist::Store::defaultPath(), this->options.cacheSize)
+        , fetcher(this->options.apiKey, this->options.jobs)
+        , refresher([this] { refresh(); }) {}
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        refresher.join();
+    }
+
+    void refresh();
+    json resolve(const debian::DebianSecurityTracker& tracker,
+                 const batch::Query& query,
+                 const std::optional<nist::CveDescription>& description) const;
+
+    const Options options;
+    // Queries take their own reference, an old tracker lives until the last query using it is done
+    std::atomic<std::shared_ptr<const debian::DebianSecurityTracker>> tracker;
+    nist::Store store;
+    // Declared after what its callbacks use, so it finishes the queries in flight first when destroyed
+    nist::Fetcher fetcher;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+    std::thread refresher;
+};
+
+void Context::Impl::refresh() {
+    std::unique_lock<std::mutex> lock(mutex);
+    // Refreshing more often than the tracker goes stale would just reopen the same database
+    while (!condition.wait_for(lock, options.trackerFreshness.maxAge, [this] { return stopping; })) {
+        lock.unlock();
+        // The new tracker is downloaded and indexed aside, queries keep using the current one meanwhile
+        try {
+            tracker.store(std::make_shared<const debian::DebianSecurityTracker>(
+                options.codename,
+                options.trackerFreshness,
+                debian::DebianSecurityTracker::RefreshMode::FOREGROUND));
+            spdlog::debug("Debian security tracker refreshed");
+        } catch (const std::exception& e) {
+            spdlog::error("Failed to refresh debian security tracker: {}", e.what());
+        }
+        lock.lock();
+    }
+}
+
+json Context::Impl::resolve(const debian::DebianSecurityTracker& tracker,
+                            const batch::Query& query,
+                            const std::optional<nist::CveDescription>& description) const {
+    try {
+        return batch::resolve(tracker, query, description, options);
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to resolve {}: {}", query.cveId, e.what());
+        return json{ { "cveId", query.cveId }, { "error", e.what() } };
+    }
+}
+
+Context::Context(Options options)
+    : mImpl(std::make_unique<Impl>(std::move(options))) {}
+
+Context::~Context() = default;
+
+void Context::query(batch::Query query, Callback done) {
+    auto tracker = mImpl->tracker.load();
+    const auto cveId = CveId::parse(query.cveId);
+    if (!cveId) {
+        // Answered with an error right away, it's not sent to the NVD
+        done(mImpl->resolve(*tracker, query, std::nullopt));
+        return;
+    }
+    nist::getCveDescriptionAsync(
+        *cveId,
+        mImpl->fetcher,
+        mImpl->store,
+        mImpl->options.nvdFreshness,
+        [impl = mImpl.get(), tracker = std::move(tracker), query = std::move(query), done = std::move(done)](
+            std::optional<nist::CveDescription> description) {
+            done(impl->resolve(*tracker, query, description));
+        });
+}
+
+std::future<json> Context::query(batch::Query query) {
+    auto promise = std::make_shared<std::promise<json>>();
+    auto future = promise->get_future();
+    this->query(std::move(query), [promise](json result) { promise->set_value(std::move(result)); });
+    return future;
+}
+
+std::vector<std::future<json>> Context::query(std::vector<batch::Query> queries) {
+    std::vector<std::future<json>> results;
+    results.reserve(queries.size());
+    for (auto& query : queries) {
+        results.push_back(this->query(std::move(query)));
+    }
+    return results;
+}
+
+const Options& Context::options() const {
+    return mImpl->options;
+}
@@ -1,66 +1,384 @@
 #include "cveinfo/cve/DebianSecurityTracker.hpp"
 
+#include "cveinfo/changes.hpp"
+#include "cveinfo/cve/TrackerParser.hpp"
+#include "cveinfo/endpoints.hpp"
+#include "cveinfo/http.hpp"
+#include "cveinfo/profile.hpp"
+#include "cveinfo/refresh.hpp"
+#include "cveinfo/utils/MappedFile.hpp"
 #include "cveinfo/utils/json.hpp"
 #include "cveinfo/utils/utils.hpp"
 
 #include <cpr/cpr.h>
+#include <nlohmann/json.hpp>
 #include <spdlog/fmt/chrono.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <fstream>
-
-using namespace std::chrono_literals;
+#include <thread>
 
 using namespace cveinfo;
+using debian::CodenameInfo;
 using debian::DebianSecurityTracker;
+using debian::PackageResolver;
+using debian::TrackerIndex;
 using debian::TrackerInfo;
 using nlohmann::json;
 
-DebianSecurityTracker::DebianSecurityTracker(std::optional<std::string> codename)
-    : mCodename(std::move(codename)) {
-    const auto dbPath = utils::createCveInfoDir() / "debian-tracker.json";
-    if (!updateDebianSecurityTrackerDb(dbPath)) {
-        if (!std::filesystem::exists(dbPath)) {
-            throw std::system_error{ std::error_code{ ENOENT, std::system_category() }, dbPath };
+namespace {
+
+/// HTTP validators of the downloaded database, stored next to it.
+struct DownloadMeta {
+    static constexpr utils::JsonField<std::string> ETAG{ "/etag" };
+    static constexpr utils::JsonField<std::string> LAST_MODIFIED{ "/lastModified" };
+    static constexpr utils::JsonField<std::int64_t> CHECKED{ "/checked" };
+
+    std::optional<std::string> etag;
+    std::optional<std::string> lastModified;
+    std::optional<std::chrono::system_clock::time_point> checked;
+
+    static std::filesystem::path path(const std::filesystem::path& dbPath) {
+        auto metaPath = dbPath;
+        metaPath += ".meta";
+        return metaPath;
+    }
+
+    static DownloadMeta load(const std::filesystem::path& dbPath) {
+        DownloadMeta meta;
+        try {
+            std::ifstream input(path(dbPath));
+            if (!input) {
+                return meta;
+            }
+            const auto j = json::parse(input);
+            meta.etag = ETAG(j);
+            meta.lastModified = LAST_MODIFIED(j);
+            if (const auto checked = CHECKED(j)) {
+                meta.checked = std::chrono::system_clock::time_point(std::chrono::seconds(*checked));
+            }
+        } catch (const std::exception& e) {
+            spdlog::warn("Ignoring corrupted debian security tracker metadata: {}", e.what());
+        }
+        return meta;
+    }
+
+    void save(const std::filesystem::path& dbPath) const {
+        json j = json::object();
+        if (etag) {
+            j["etag"] = *etag;
+        }
+        if (lastModified) {
+            j["lastModified"] = *lastModified;
+        }
+        if (checked) {
+            j["checked"] =
+                std::chrono::duration_cast<std::chrono::seconds>(checked->time_since_epoch()).count();
+        }
+        if (!(std::ofstream(path(dbPath)) << j.dump())) {
+            spdlog::warn("Failed to save debian security tracker metadata");
         }
-        mJsonDatabase = json::parse(std::ifstream(dbPath));
-        spdlog::warn("Using local debian security tracker database from {}", utils::lastWriteTime(dbPath));
-    } else {
-        mJsonDatabase = json::parse(std::ifstream(dbPath));
     }
+};
+
+std::optional<std::string> headerValue(const cpr::Header& header, const std::string& name) {
+    const auto it = header.find(name);
+    return it != std::end(header) ? std::optional(it->second) : std::nullopt;
 }
 
-std::vector<TrackerInfo> DebianSecurityTracker::getTrackerInfo(const std::string& cveId) const {
-    std::vector<TrackerInfo> infos;
+/// Time since the database was last downloaded or revalidated, std::nullopt if there's none.
+std::optional<std::chrono::system_clock::duration> databaseAge(const std::filesystem::path& dbPath) {
+    if (!std::filesystem::exists(dbPath)) {
+        return std::nullopt;
+    }
+    const auto meta = DownloadMeta::load(dbPath);
+    return std::chrono::system_clock::now() - (meta.checked ? *meta.checked : utils::lastWriteTime(dbPath));
+}
 
-    const auto addCodenameInfo = [](TrackerInfo& info, const json& releases, const std::string& codename) {
-        if (const auto desiredRelease = utils::getAs<json>(releases, "/" + codename)) {
-            auto status = utils::getAs<std::string>(*desiredRelease, "/status");
-            auto fixedVersion = utils::getAs<std::string>(*desiredRelease, "/fixed_version");
-            info.codenames.push_back(CodenameInfo{ codename, std::move(status), std::move(fixedVersion) });
-        } else {
-            spdlog::warn("Given Debian release not found: {}", codename);
+std::filesystem::path lockPath(const std::filesystem::path& dbPath) {
+    auto path = dbPath;
+    path += ".lock";
+    return path;
+}
+
+/// Index of the database @p dbPath, restricted to the releases of @p codename if set.
+std::filesystem::path indexPathOf(const std::filesystem::path& dbPath,
+                                  const std::optional<std::string>& codename) {
+    // An index restricted to a single codename is smaller, so it's kept separately from the full one
+    return dbPath.parent_path() /
+           (codename ? "debian-tracker-" + *codename + ".idx" : std::string("debian-tracker.idx"));
+}
+
+/// Identifies the JSON of a package, see TrackerIndex::sourceHash()
+///
+/// FNV-1a rather than std::hash, whose values may differ between standard libraries: the hash is stored
+/// in the index and in snapshots, which may come from another build.
+std::uint64_t sourceHash(const debian::TrackerParser::Package& package) {
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (const char c : package.value) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    }
+    // 0 stands for an unknown hash
+    return hash != 0 ? hash : 1;
+}
+
+/// Indexes @p packages on @p threads threads, returns a builder holding their records in document order.
+///
+/// The records of the packages hashing the same as in @p previous are taken over from it, the others are
+/// parsed.
+debian::TrackerIndex::Builder indexPackages(const std::vector<debian::TrackerParser::Package>& packages,
+                                            const debian::TrackerIndex* previous,
+                                            std::size_t threads) {
+    // One chunk of about the same size per thread, every further chunk would repeat some of the strings
+    // of the others in the index
+    const auto chunkCount = std::min(threads, packages.size());
+    std::size_t totalSize = 0;
+    for (const auto& package : packages) {
+        totalSize += package.value.size();
+    }
+    std::vector<std::size_t> chunkEnds;
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < packages.size(); ++i) {
+        size += packages[i].value.size();
+        if (size * chunkCount >= totalSize * (chunkEnds.size() + 1)) {
+            chunkEnds.push_back(i + 1);
+        }
+    }
+
+    // Each chunk fills its own builder, appended in document order they index like a serial parse
+    std::vector<debian::TrackerIndex::Builder> builders(chunkEnds.size());
+    std::vector<std::exception_ptr> errors(chunkEnds.size());
+    std::atomic<std::size_t> next = 0;
+    std::atomic<std::size_t> parsed = 0;
+    const auto worker = [&] {
+        for (std::size_t chunk; (chunk = next++) < chunkEnds.size();) {
+            try {
+                auto& builder = builders[chunk];
+                debian::TrackerParser parser(builder, std::nullopt);
+                for (auto i = chunk == 0 ? 0 : chunkEnds[chunk - 1]; i < chunkEnds[chunk]; ++i) {
+                    const auto& package = packages[i];
+                    const auto hash = sourceHash(package);
+                    const auto number = previous ? previous->packageNumber(package.name) : std::nullopt;
+                    if (number && previous->sourceHash(*number) == hash) {
+                        builder.copyPackage(*previous, *number);
+                    } else {
+                        parser.parsePackage(package);
+                        builder.setSourceHash(package.name, hash);
+                        ++parsed;
+                    }
+                }
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
         }
     };
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    spdlog::debug("Parsed {} of {} packages", parsed.load(), packages.size());
 
-    try {
-        for (auto package = std::begin(mJsonDatabase); package != std::end(mJsonDatabase); ++package) {
-            const auto& cveIt = package->find(cveId);
-            if (cveIt == std::end(*package)) {
-                continue;
+    const profile::Scope scope("tracker.merge");
+    if (builders.empty()) {
+        return {};
+    }
+    auto builder = std::move(builders.front());
+    for (auto it = std::next(std::begin(builders)); it != std::end(builders); ++it) {
+        builder.append(*it);
+        *it = {};
+    }
+    return builder;
+}
+
+/// Writes the full index of @p dbPath to @p indexPath, updating @p previous if given.
+void buildIndex(const std::filesystem::path& dbPath,
+                const std::filesystem::path& indexPath,
+                const debian::TrackerIndex::SourceStamp& source,
+                const debian::TrackerIndex* previous) {
+    const profile::Scope scope("tracker.index");
+    spdlog::info("Indexing debian security tracker database...");
+    spdlog::debug("Peak RSS before indexing: {} KiB", utils::peakResidentSetSize() / 1024);
+
+    const utils::MappedFile file(dbPath);
+    // The packages are independent, so they're parsed on all cores once their boundaries are known
+    const auto packages = [&] {
+        const profile::Scope scope("tracker.split");
+        return debian::TrackerParser::splitPackages(file.view());
+    }();
+    const auto threads =
+        packages ? std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, packages->size() / 64 + 1)
+                 : 1;
+    debian::TrackerIndex::Builder builder;
+    if (packages) {
+        builder = indexPackages(*packages, previous, threads);
+    } else {
+        debian::TrackerParser(builder, std::nullopt).parse(file.view());
+    }
+    builder.write(indexPath, source);
+
+    spdlog::debug("Indexed {} records on {} threads, peak RSS after indexing: {} KiB",
+                  builder.recordCount(),
+                  threads,
+                  utils::peakResidentSetSize() / 1024);
+}
+
+/// Brings the full index of @p dbPath up to date and publishes the changes since the index it replaces.
+TrackerIndex updateFullIndex(const std::filesystem::path& dbPath, const TrackerIndex::SourceStamp& source) {
+    const auto indexPath = indexPathOf(dbPath, std::nullopt);
+    if (auto index = TrackerIndex::open(indexPath, source)) {
+        return std::move(*index);
+    }
+    // The index of an older database still has the records of all the packages that didn't change since
+    const auto previous = TrackerIndex::open(indexPath, std::nullopt);
+    buildIndex(dbPath, indexPath, source, previous ? &*previous : nullptr);
+    auto index = TrackerIndex::open(indexPath, source);
+    if (!index) {
+        throw std::runtime_error("Failed to index the debian security tracker database");
+    }
+    if (previous) {
+        const profile::Scope scope("tracker.diff");
+        changes::publish(changes::diff(*previous, *index));
+    }
+    return std::move(*index);
+}
+
+} // namespace
+
+DebianSecurityTracker::DebianSecurityTracker(std::optional<std::string> codename,
+                                             const utils::Freshness& freshness,
+                                             RefreshMode refreshMode)
+    : mCodename(std::move(codename)) {
+    const profile::Scope scope("tracker.load");
+    const auto dbPath = databasePath();
+
+    using State = utils::Freshness::State;
+    const auto state = freshness.of(databaseAge(dbPath));
+    if (state == State::STALE && refreshMode == RefreshMode::BACKGROUND) {
+        spdlog::debug("Refreshing debian security tracker database in the background");
+        // The background process decides on its own whether the database still needs a refresh
+        std::vector<std::string> arguments = {
+            "--refresh-tracker", "--tracker-max-age", std::to_string(freshness.maxAge.count())
+        };
+        if (mCodename) {
+            arguments.insert(std::end(arguments), { "--codename", *mCodename });
+        }
+        refresh::spawn(arguments);
+    } else if (state != State::FRESH) {
+        // Whoever holds the lease is downloading already, its download is good for us too
+        const auto lease = [&] {
+            const profile::Scope scope("tracker.lease_wait");
+            return refresh::Lease::acquire(lockPath(dbPath));
+        }();
+        if (freshness.of(databaseAge(dbPath)) != State::FRESH && !updateDebianSecurityTrackerDb(dbPath)) {
+            if (!std::filesystem::exists(dbPath)) {
+                throw std::system_error{ std::error_code{ ENOENT, std::system_category() }, dbPath };
             }
+            spdlog::warn("Using local debian security tracker database from {}",
+                         utils::lastWriteTime(dbPath));
+        }
+    }
+    mIndex = openIndex(dbPath, mCodename);
+}
 
-            const auto& cve = *cveIt;
+bool DebianSecurityTracker::refresh(const std::optional<std::string>& codename,
+                                    const utils::Freshness& freshness) {
+    const auto dbPath = databasePath();
+    {
+        const auto lease = refresh::Lease::tryAcquire(lockPath(dbPath));
+        if (!lease) {
+            spdlog::debug("Debian security tracker database is being refreshed by another process");
+            return true;
+        }
+        if (freshness.of(databaseAge(dbPath)) != utils::Freshness::State::FRESH &&
+            !updateDebianSecurityTrackerDb(dbPath)) {
+            return false;
+        }
+    }
+    // Index it right away, so the next lookup doesn't have to
+    try {
+        openIndex(dbPath, codename);
+        return true;
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to index debian security tracker database: {}", e.what());
+        return false;
+    }
+}
+
+std::filesystem::path DebianSecurityTracker::databasePath() {
+    return utils::createCveInfoDir() / "debian-tracker.json";
+}
+
+refresh::Lease DebianSecurityTracker::lockDatabase() {
+    return refresh::Lease::acquire(lockPath(databasePath()));
+}
+
+TrackerIndex DebianSecurityTracker::openIndex(const std::filesystem::path& dbPath,
+                                              const std::optional<std::string>& codename) {
+    // The index is stamped with the database it was built from, so a fresh download invalidates it
+    const auto indexPath = indexPathOf(dbPath, codename);
+    if (auto index = TrackerIndex::open(indexPath, TrackerIndex::SourceStamp::of(dbPath))) {
+        return std::move(*index);
+    }
+
+    // Indexed once by whoever comes first, the others wait for that index
+    const auto lease = refresh::Lease::acquire(lockPath(dbPath));
+    const auto source = TrackerIndex::SourceStamp::of(dbPath);
+    auto full = updateFullIndex(dbPath, source);
+    if (!codename) {
+        return full;
+    }
+    if (auto index = TrackerIndex::open(indexPath, source)) {
+        return std::move(*index);
+    }
+    // Derived from the full index rather than the database, which then doesn't need to be parsed again
+    TrackerIndex::Builder builder;
+    for (std::size_t i = 0; i < full.packageCount(); ++i) {
+        builder.copyPackage(full, i, *codename);
+    }
+    builder.write(indexPath, source);
+    if (auto index = TrackerIndex::open(indexPath, source)) {
+        return std::move(*index);
+    }
+    throw std::runtime_error("Failed to index the debian security tracker database");
+}
+
+std::vector<TrackerInfo> DebianSecurityTracker::getTrackerInfo(CveId cveId) const {
+    const profile::Scope scope("tracker.lookup");
+    std::vector<TrackerInfo> infos;
+
+    try {
+        for (const auto& record : mIndex->find(cveId)) {
             TrackerInfo info;
-            info.packageName = package.key();
+            info.packageName = mIndex->string(record.package);
             info.cveId = cveId;
 
-            if (const auto releases = utils::getAs<json>(cve, "/releases")) {
+            if (record.flags & TrackerIndex::Record::HAS_RELEASES) {
+                const auto releases = mIndex->releases(record);
                 if (mCodename) {
-                    addCodenameInfo(info, *releases, *mCodename);
+                    const auto release =
+                        std::find_if(std::begin(releases), std::end(releases), [&](const auto& release) {
+                            return mIndex->string(release.codename) == *mCodename;
+                        });
+                    if (release != std::end(releases)) {
+                        info.codenames.push_back(makeCodenameInfo(*release));
+                    } else {
+                        spdlog::warn("Given Debian release not found: {}", *mCodename);
+                    }
                 } else {
-                    for (auto codename = std::begin(*releases); codename != std::end(*releases); ++codename) {
-                        addCodenameInfo(info, *releases, codename.key());
+                    for (const auto& release : releases) {
+                        info.codenames.push_back(makeCodenameInfo(release));
                     }
                 }
             }
@@ -75,23 +393,145 @@ std::vector<TrackerInfo> DebianSecurityTracker::getTrackerInfo(const std::string
     }
 }
 
-bool DebianSecurityTracker::updateDebianSecurityTrackerDb(const std::filesystem::path& dbPath) const {
+std::vector<TrackerInfo>
+DebianSecurityTracker::getPackageInfo(const std::string& packageName,
+                                      const std::optional<std::string>& status) const {
+    const profile::Scope scope("tracker.lookup");
+    std::vector<TrackerInfo> infos;
+
     try {
-        if (!std::filesystem::exists(dbPath) || dbPath == utils::OlderThan(1h)) {
-            spdlog::info("Downloading debian security tracker database...");
-            cpr::Response r = cpr::Get(cpr::Url{ "https://security-tracker.debian.org/tracker/data/json" },
-                                       cpr::VerifySsl{ false });
-            if (r.status_code != 200) {
-                spdlog::error("Failed to download debian security tracker database ({}): {}",
-                              r.status_code,
-                              r.error.message);
-                return false;
+        const auto packageRecords = mIndex->findPackage(packageName);
+        infos.reserve(packageRecords.size());
+        for (const auto& packageRecord : packageRecords) {
+            const auto& record = mIndex->record(packageRecord);
+            TrackerInfo info;
+            info.packageName = packageName;
+            info.cveId = mIndex->cveId(packageRecord);
+
+            if (record.flags & TrackerIndex::Record::HAS_RELEASES) {
+                for (const auto& release : mIndex->releases(record)) {
+                    if (mCodename && mIndex->string(release.codename) != *mCodename) {
+                        continue;
+                    }
+                    if (status && mIndex->optionalString(release.status) != *status) {
+                        continue;
+                    }
+                    info.codenames.push_back(makeCodenameInfo(release));
+                }
+            }
+            // Filtered out releases leave the CVE without anything to report
+            if ((mCodename || status) && info.codenames.empty()) {
+                continue;
             }
-            return bool(std::ofstream(dbPath) << r.text);
+            infos.push_back(std::move(info));
+        }
+        return infos;
+    } catch (const std::exception& e) {
+        spdlog::error("Error occurred while searching for {} in the debian security tracker: {}",
+                      packageName,
+                      e.what());
+        return {};
+    }
+}
+
+std::vector<PackageResolver::Match> DebianSecurityTracker::resolvePackage(std::string_view packageName,
+                                                                          std::size_t limit) const {
+    std::call_once(mResolver->built, [this] {
+        const profile::Scope scope("tracker.resolver");
+        std::vector<std::string_view> names;
+        names.reserve(mIndex->packageCount());
+        for (std::size_t i = 0; i < mIndex->packageCount(); ++i) {
+            names.push_back(mIndex->packageName(i));
+        }
+        mResolver->resolver.emplace(std::move(names));
+    });
+    return mResolver->resolver->resolve(packageName, limit);
+}
+
+CodenameInfo DebianSecurityTracker::makeCodenameInfo(const TrackerIndex::Release& release) const {
+    const auto status = mIndex->optionalString(release.status);
+    const auto fixedVersion = mIndex->optionalString(release.fixedVersion);
+    return CodenameInfo{ std::string(mIndex->string(release.codename)),
+                         status ? std::optional<std::string>(*status) : std::nullopt,
+                         fixedVersion ? std::optional<std::string>(*fixedVersion) : std::nullopt };
+}
+
+bool DebianSecurityTracker::updateDebianSecurityTrackerDb(const std::filesystem::path& dbPath) {
+    auto tmpPath = dbPath;
+    tmpPath += ".tmp";
+    const profile::Scope scope("tracker.download");
+    try {
+        const bool exists = std::filesystem::exists(dbPath);
+        auto meta = exists ? DownloadMeta::load(dbPath) : DownloadMeta{};
+
+        // Revalidate what we have, an unchanged database then costs just a 304 response
+        cpr::Header header;
+        if (exists && meta.etag) {
+            header.emplace("If-None-Match", *meta.etag);
+        }
+        if (exists && meta.lastModified) {
+            header.emplace("If-Modified-Since", *meta.lastModified);
+        }
+
+        if (header.empty()) {
+            spdlog::info("Downloading debian security tracker database...");
+        } else {
+            spdlog::info("Checking for debian security tracker database updates...");
+        }
+        // Stream the body straight to disk instead of holding the whole database in memory
+        std::ofstream output(tmpPath, std::ios::binary | std::ios::trunc);
+        profile::add(profile::Counter::HTTP_REQUESTS);
+        cpr::Response r = http::download(
+            endpoints::trackerUrl(), header, cpr::WriteCallback{ [&output](std::string_view data, intptr_t) {
+                profile::add(profile::Counter::BYTES_DOWNLOADED, data.size());
+                return bool(output.write(data.data(), static_cast<std::streamsize>(data.size())));
+            } });
+        output.close();
+
+        if (r.status_code == 304 && exists) {
+            spdlog::info("Debian security tracker database is up to date");
+            std::filesystem::remove(tmpPath);
+        } else if (r.status_code == 200 && output) {
+            std::filesystem::rename(tmpPath, dbPath);
+            meta.etag = headerValue(r.header, "ETag");
+            meta.lastModified = headerValue(r.header, "Last-Modified");
+        } else {
+            spdlog::error("Failed to download debian security tracker database ({}): {}",
+                          r.status_code,
+                          r.error.message);
+            std::filesystem::remove(tmpPath);
+            return false;
         }
+        meta.checked = std::chrono::system_clock::now();
+        meta.save(dbPath);
         return true;
     } catch (const std::exception& e) {
         spdlog::error("Failed to update debian security tracker database: {}", e.what());
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
         return false;
     }
 }
+
+std::vector<TrackerInfo>::const_iterator debian::findPackage(const std::vector<TrackerInfo>& infos,
+                                                             const std::string& packageName) {
+    const PackageResolver::Query query(packageName);
+    auto best = std::end(infos);
+    float bestScore = 0;
+    for (auto it = std::begin(infos); it != std::end(infos) && bestScore < PackageResolver::EXACT; ++it) {
+        if (const auto score = query.score(it->packageName); score > bestScore) {
+            best = it;
+            bestScore = score;
+        }
+    }
+    if (bestScore < PackageResolver::MIN_SCORE) {
+        return std::end(infos);
+    }
+    if (bestScore < PackageResolver::EXACT) {
+        spdlog::warn("Given CVE ID {} matching package name only partially: {} ~= {}",
+                     best->cveId,
+                     packageName,
+                     best->packageName);
+    }
+    return best;
+}
@@ -0,0 +1,246 @@
+#include "cveinfo/cve/NistFetcher.hpp"
+
+#include "cveinfo/endpoints.hpp"
+#include "cveinfo/http.hpp"
+#include "cveinfo/profile.hpp"
+
+#include <cpr/cpr.h>
+#include <spdlog/spdlog.h>
+
+#include <ctime>
+#include <random>
+
+using namespace std::chrono_literals;
+using namespace cveinfo;
+using nist::Fetcher;
+
+namespace {
+
+// Published NVD API rate limits: 5 requests in a rolling 30 second window, 50 with an API key
+constexpr std::size_t PUBLIC_REQUESTS_PER_WINDOW = 5;
+constexpr std::size_t API_KEY_REQUESTS_PER_WINDOW = 50;
+constexpr auto RATE_LIMIT_WINDOW = 30s;
+
+constexpr int MAX_ATTEMPTS = 4;
+constexpr auto BACKOFF_BASE = 5s;
+constexpr auto BACKOFF_MAX = 60s;
+
+std::nullopt_t handleNonOkStatusCode(long code, const std::string& subject) {
+    switch (code) {
+    case 403:
+        spdlog::error("{} - request forbidden: try limiting the request frequency", subject);
+        return std::nullopt;
+    case 404:
+        spdlog::error("{} not found in the NIST database", subject);
+        return std::nullopt;
+    case 503:
+        spdlog::error("Couldn't retrieve infornation about {} - NIST database temporarily unavailable",
+                      subject);
+        return std::nullopt;
+    case 500:
+        spdlog::error("Couldn't retrieve infornation about {} - internal server error in the NIST database",
+                      subject);
+        return std::nullopt;
+    default:
+        spdlog::error("Couldn't retrieve infornation about {} - status code {}", subject, code);
+        return std::nullopt;
+    }
+}
+
+bool isRateLimited(long code) {
+    return code == 403 || code == 429 || code == 503;
+}
+
+std::optional<std::chrono::seconds> parseRetryAfter(const std::string& value) {
+    // Either a number of seconds...
+    char* end = nullptr;
+    const long seconds = std::strtol(value.c_str(), &end, 10);
+    if (end != value.c_str() && *end == '\0') {
+        return std::chrono::seconds(std::max(seconds, 0L));
+    }
+    // ...or an HTTP date
+    std::tm tm{};
+    if (strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm) != nullptr) {
+        const auto at = std::chrono::system_clock::from_time_t(timegm(&tm));
+        const auto now = std::chrono::system_clock::now();
+        return std::chrono::ceil<std::chrono::seconds>(
+            std::max(at - now, std::chrono::system_clock::duration{}));
+    }
+    return std::nullopt;
+}
+
+std::chrono::steady_clock::duration retryDelay(const cpr::Response& r, int attempt) {
+    if (const auto it = r.header.find("Retry-After"); it != std::end(r.header)) {
+        if (const auto retryAfter = parseRetryAfter(it->second)) {
+            return *retryAfter;
+        }
+    }
+    // Exponential backoff with jitter, so the rescheduled requests don't all hit the server at once
+    thread_local std::minstd_rand random{ std::random_device{}() };
+    const std::chrono::steady_clock::duration backoff = std::min<std::chrono::steady_clock::duration>(
+        BACKOFF_BASE * (1 << attempt), BACKOFF_MAX);
+    std::uniform_int_distribution<std::chrono::steady_clock::rep> jitter(backoff.count() / 2,
+                                                                         backoff.count());
+    return std::chrono::steady_clock::duration(jitter(random));
+}
+
+} // namespace
+
+double Fetcher::Stats::requestsPerSecond() const {
+    const auto seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? static_cast<double>(requests) / seconds : 0;
+}
+
+Fetcher::Fetcher(std::optional<std::string> apiKey, std::size_t workers)
+    : mApiKey(std::move(apiKey))
+    , mUrl(endpoints::nvdUrl())
+    , mRateLimiter(endpoints::nvdRateLimit().value_or(mApiKey ? API_KEY_REQUESTS_PER_WINDOW
+                                                              : PUBLIC_REQUESTS_PER_WINDOW),
+                   RATE_LIMIT_WINDOW)
+    , mStarted(Clock::now()) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(workers, 1); ++i) {
+        mWorkers.emplace_back([this] { work(); });
+    }
+}
+
+Fetcher::~Fetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+void Fetcher::fetch(std::string query, std::string subject, Callback done) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Request request{ std::move(query), std::move(subject), std::move(done) };
+        request.sequence = mSequence++;
+        mQueue.push(std::move(request));
+    }
+    mCondition.notify_one();
+}
+
+std::future<std::optional<std::string>> Fetcher::fetch(std::string query, std::string subject) {
+    auto promise = std::make_shared<std::promise<std::optional<std::string>>>();
+    auto future = promise->get_future();
+    fetch(std::move(query), std::move(subject), [promise](std::optional<std::string> body) {
+        promise->set_value(std::move(body));
+    });
+    return future;
+}
+
+Fetcher::Stats Fetcher::stats() const {
+    return Stats{ mRequests, mForbidden, mRetries, mFailures, Clock::now() - mStarted };
+}
+
+void Fetcher::logStats() const {
+    const auto current = stats();
+    if (current.requests == 0) {
+        return;
+    }
+    const auto connections = http::stats();
+    spdlog::info("NVD: {} requests in {:.1f}s ({:.2f} requests/s), {} forbidden, {} retries, {} failed, "
+                 "{} connections opened, {} reused",
+                 current.requests,
+                 std::chrono::duration<double>(current.elapsed).count(),
+                 current.requestsPerSecond(),
+                 current.forbidden,
+                 current.retries,
+                 current.failures,
+                 connections.opened,
+                 connections.reused);
+}
+
+void Fetcher::work() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        if (mQueue.empty()) {
+            if (mStopping) {
+                return;
+            }
+            mCondition.wait(lock);
+            continue;
+        }
+        // Requests backing off stay in the queue, so they never hold up a worker
+        const auto notBefore = mQueue.top().notBefore;
+        if (notBefore > Clock::now()) {
+            mCondition.wait_until(lock, notBefore);
+            continue;
+        }
+        Request request = mQueue.top();
+        mQueue.pop();
+        lock.unlock();
+        send(std::move(request));
+        lock.lock();
+    }
+}
+
+void Fetcher::send(Request request) {
+    // Includes the backoff of the retried requests
+    profile::record(request.attempt > 0 ? "nvd.backoff" : "nvd.queued", request.queued);
+    {
+        const profile::Scope scope("nvd.rate_limit_wait");
+        mRateLimiter.acquire();
+    }
+    ++mRequests;
+    profile::add(profile::Counter::HTTP_REQUESTS);
+
+    std::optional<std::string> body;
+    try {
+        cpr::Header apiKeyHeader;
+        if (mApiKey) {
+            apiKeyHeader.emplace("apiKey", *mApiKey);
+        }
+        cpr::Response r = [&] {
+            const profile::Scope scope("nvd.http");
+            return http::get(mUrl + "?" + request.query, apiKeyHeader);
+        }();
+        profile::add(profile::Counter::BYTES_DOWNLOADED, r.text.size());
+
+        // If the response is "forbidden", it probably means we're sending too many requests.
+        // Let's try again later.
+        if (isRateLimited(r.status_code)) {
+            profile::add(profile::Counter::RATE_LIMITED);
+            if (r.status_code == 403) {
+                ++mForbidden;
+            }
+            if (request.attempt + 1 < MAX_ATTEMPTS) {
+                const auto delay = retryDelay(r, request.attempt);
+                spdlog::debug("{} - rate limited ({}), retrying in {}s",
+                              request.subject,
+                              r.status_code,
+                              std::chrono::duration_cast<std::chrono::seconds>(delay).count());
+                retry(std::move(request), delay);
+                return;
+            }
+        }
+        if (r.status_code == 200) {
+            body = std::move(r.text);
+        } else {
+            ++mFailures;
+            handleNonOkStatusCode(r.status_code, request.subject);
+        }
+    } catch (const std::exception& e) {
+        ++mFailures;
+        spdlog::error("Couldn't retrieve infornation about {} - {}", request.subject, e.what());
+    }
+    request.done(std::move(body));
+}
+
+void Fetcher::retry(Request request, Clock::duration delay) {
+    ++mRetries;
+    profile::add(profile::Counter::RETRIES);
+    ++request.attempt;
+    request.queued = Clock::now();
+    request.notBefore = request.queued + delay;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        request.sequence = mSequence++;
+        mQueue.push(std::move(request));
+    }
+    mCondition.notify_one();
+}
@@ -0,0 +1,111 @@
+#include "cveinfo/cve/NistMirror.hpp"
+
+#include "cveinfo/changes.hpp"
+#include "cveinfo/cve/NistFetcher.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/nist.hpp"
+#include "cveinfo/cve/schema.hpp"
+#include "cveinfo/utils/utils.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/fmt/chrono.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <fstream>
+#include <vector>
+
+using namespace cveinfo;
+using nist::Mirror;
+using nlohmann::json;
+
+namespace {
+
+// The NVD API rejects lastModified windows longer than 120 days, a full sync is needed after that
+constexpr auto MAX_SYNC_WINDOW = std::chrono::days(120);
+
+constexpr auto STATE_FILE = "sync-state.json";
+constexpr utils::JsonField<std::int64_t> LAST_SYNC("/lastSync");
+
+std::string formatDate(std::chrono::system_clock::time_point time) {
+    return fmt::format("{:%Y-%m-%dT%H:%M:%S}.000", fmt::gmtime(std::chrono::system_clock::to_time_t(time)));
+}
+
+} // namespace
+
+Mirror::Mirror(Store& store, std::filesystem::path directory)
+    : mStore(store)
+    , mDirectory(std::move(directory)) {}
+
+std::filesystem::path Mirror::defaultDirectory() {
+    return utils::createCveInfoDir() / "nvd";
+}
+
+bool Mirror::sync(Fetcher& fetcher) {
+    try {
+        std::filesystem::create_directories(mDirectory);
+        const auto now = std::chrono::system_clock::now();
+
+        std::string window;
+        if (const auto last = lastSync(); last && now - *last < MAX_SYNC_WINDOW) {
+            spdlog::info("Synchronizing NVD records modified since {}...", *last);
+            window = fmt::format(
+                "lastModStartDate={}&lastModEndDate={}", formatDate(*last), formatDate(now));
+        } else {
+            spdlog::info("Synchronizing the whole NVD database...");
+        }
+
+        std::atomic<std::size_t> stored = 0;
+        std::atomic<std::size_t> total = 0;
+        const bool complete = fetchPages(fetcher, window, "NVD", [this, &stored, &total](const json& page) {
+            total = schema::TOTAL_RESULTS(page).value_or(0);
+            stored += storePage(page);
+            return true;
+        });
+        spdlog::info("Synchronized {} of {} NVD records", stored.load(), total.load());
+        if (!complete) {
+            spdlog::error("NVD synchronization incomplete, the next sync will retry");
+            return false;
+        }
+        setLastSync(now);
+        return true;
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to synchronize NVD mirror: {}", e.what());
+        return false;
+    }
+}
+
+std::optional<std::chrono::system_clock::time_point> Mirror::lastSync() const {
+    try {
+        std::ifstream input(mDirectory / STATE_FILE);
+        if (!input) {
+            return std::nullopt;
+        }
+        const auto seconds = LAST_SYNC(json::parse(input));
+        if (!seconds) {
+            return std::nullopt;
+        }
+        return std::chrono::system_clock::time_point(std::chrono::seconds(*seconds));
+    } catch (const std::exception& e) {
+        spdlog::warn("Ignoring corrupted NVD mirror state: {}", e.what());
+        return std::nullopt;
+    }
+}
+
+void Mirror::setLastSync(std::chrono::system_clock::time_point time) const {
+    const json state = {
+        { "lastSync", std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count() }
+    };
+    if (!(std::ofstream(mDirectory / STATE_FILE) << state.dump())) {
+        spdlog::warn("Failed to save NVD mirror state");
+    }
+}
+
+std::size_t Mirror::storePage(const json& page) const {
+    const auto descriptions = parsePage(page);
+    const auto changed = changes::diff(mStore, descriptions);
+    // One append per page keeps the writer lock traffic low
+    mStore.put(descriptions, std::chrono::system_clock::now(), Store::MIRRORED);
+    changes::publish(changed);
+    return descriptions.size();
+}
@@ -0,0 +1,897 @@
+#include "cveinfo/cve/NistStore.hpp"
+
+#include "cveinfo/cve/schema.hpp"
+#include "cveinfo/cve/serialization.hpp"
+#include "cveinfo/profile.hpp"
+#include "cveinfo/utils/utils.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <sys/file.h>
+
+using namespace cveinfo;
+using nist::Store;
+using nlohmann::json;
+
+namespace {
+
+constexpr char DATA_MAGIC[8] = { 'C', 'V', 'E', 'S', 'T', 'O', 'R', 'E' };
+constexpr char INDEX_MAGIC[8] = { 'C', 'V', 'E', 'S', 'I', 'D', 'X', '\0' };
+constexpr std::uint32_t STORE_VERSION = 1;
+constexpr std::uint32_t RECORD_MAGIC = 0x31525643; // "CVR1"
+
+// Records appended after the indexed part of the data file are re-indexed once they take this much space
+constexpr std::uint64_t MAX_TAIL_SIZE = 1024 * 1024;
+// Smaller stores aren't worth compacting even if most of their records were superseded
+constexpr std::uint64_t MIN_COMPACTION_SIZE = 4 * 1024 * 1024;
+constexpr std::size_t SCAN_CHUNK_SIZE = 1024 * 1024;
+constexpr int COMPRESSION_LEVEL = 3;
+
+struct DataHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+};
+
+struct RecordHeader {
+    std::uint32_t magic;
+    std::uint32_t checksum;
+    std::uint16_t keyLength;
+    std::uint16_t flags;
+    std::uint32_t payloadLength;
+    std::int64_t fetched;
+};
+
+enum PayloadField : std::uint8_t {
+    DESCRIPTION = 1 << 0,
+    VECTOR_STRING = 1 << 1,
+    SEVERITY = 1 << 2,
+    SCORE = 1 << 3,
+};
+
+class FileLock {
+public:
+    explicit FileLock(const std::filesystem::path& path)
+        : mFd(::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) {
+        if (mFd < 0 || flock(mFd, LOCK_EX) != 0) {
+            const int error = errno;
+            if (mFd >= 0) {
+                ::close(mFd);
+            }
+            throw std::system_error{ std::error_code{ error, std::system_category() }, path };
+        }
+    }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    ~FileLock() {
+        flock(mFd, LOCK_UN);
+        ::close(mFd);
+    }
+
+private:
+    int mFd;
+};
+
+/// First slot of the index table of @p capacity to probe for @p key. Consecutive IDs are spread out by a
+/// multiplicative hash, the low bits of their sequence numbers alone would make for long probe chains.
+std::uint64_t firstSlot(std::uint64_t key, std::uint64_t capacity) {
+    return (key * 0x9e3779b97f4a7c15 >> 32) & (capacity - 1);
+}
+
+/// Packed CveId of the record with @p header and @p key, std::nullopt if the key isn't one
+std::optional<std::uint64_t> packedKey(const RecordHeader& header, std::string_view key) {
+    std::uint64_t value;
+    if (header.keyLength != sizeof(value)) {
+        return std::nullopt;
+    }
+    std::memcpy(&value, key.data(), sizeof(value));
+    return value != 0 ? std::optional(value) : std::nullopt;
+}
+
+std::uint32_t fnv1a(std::uint32_t hash, std::string_view data) {
+    for (const char c : data) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x01000193;
+    }
+    return hash;
+}
+
+std::uint32_t checksum(const RecordHeader& header, std::string_view key, std::string_view payload) {
+    const auto* fields = reinterpret_cast<const char*>(&header) + offsetof(RecordHeader, keyLength);
+    std::uint32_t hash = fnv1a(0x811c9dc5, { fields, sizeof(header) - offsetof(RecordHeader, keyLength) });
+    hash = fnv1a(hash, key);
+    return fnv1a(hash, payload);
+}
+
+/// Appends a record of @p cveId with the compressed @p payload to @p out
+void appendRecord(std::string& out,
+                  std::uint64_t cveId,
+                  std::uint16_t flags,
+                  std::int64_t fetched,
+                  std::string_view payload) {
+    const std::string_view key(reinterpret_cast<const char*>(&cveId), sizeof(cveId));
+    RecordHeader header{ RECORD_MAGIC,
+                         0,
+                         static_cast<std::uint16_t>(key.size()),
+                         flags,
+                         static_cast<std::uint32_t>(payload.size()),
+                         fetched };
+    header.checksum = checksum(header, key, payload);
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(key);
+    out.append(payload);
+}
+
+std::uint32_t hoursSinceEpoch(std::chrono::system_clock::time_point time) {
+    return static_cast<std::uint32_t>(
+        std::chrono::duration_cast<std::chrono::hours>(time.time_since_epoch()).count());
+}
+
+void appendString(std::string& out, const std::string& str) {
+    const auto length = static_cast<std::uint32_t>(str.size());
+    out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.append(str);
+}
+
+std::string readString(std::string_view& in) {
+    std::uint32_t length;
+    if (in.size() < sizeof(length)) {
+        throw std::runtime_error("truncated record");
+    }
+    std::memcpy(&length, in.data(), sizeof(length));
+    in.remove_prefix(sizeof(length));
+    if (in.size() < length) {
+        throw std::runtime_error("truncated record");
+    }
+    std::string str(in.substr(0, length));
+    in.remove_prefix(length);
+    return str;
+}
+
+std::string encode(const nist::CveDescription& description) {
+    std::string out(1, '\0');
+    std::uint8_t fields = 0;
+    if (description.description) {
+        fields |= DESCRIPTION;
+        appendString(out, *description.description);
+    }
+    if (description.vectorString) {
+        fields |= VECTOR_STRING;
+        appendString(out, *description.vectorString);
+    }
+    if (description.severity) {
+        fields |= SEVERITY;
+        appendString(out, *description.severity);
+    }
+    if (description.score) {
+        fields |= SCORE;
+        out.append(reinterpret_cast<const char*>(&*description.score), sizeof(float));
+    }
+    out[0] = static_cast<char>(fields);
+    return out;
+}
+
+nist::CveDescription decode(CveId cveId, std::string_view in) {
+    nist::CveDescription description;
+    description.cveId = cveId;
+    if (in.empty()) {
+        throw std::runtime_error("truncated record");
+    }
+    const auto fields = static_cast<std::uint8_t>(in.front());
+    in.remove_prefix(1);
+    if (fields & DESCRIPTION) {
+        description.description = readString(in);
+    }
+    if (fields & VECTOR_STRING) {
+        description.vectorString = readString(in);
+    }
+    if (fields & SEVERITY) {
+        description.severity = readString(in);
+    }
+    if (fields & SCORE) {
+        float score;
+        if (in.size() < sizeof(score)) {
+            throw std::runtime_error("truncated record");
+        }
+        std::memcpy(&score, in.data(), sizeof(score));
+        description.score = score;
+    }
+    return description;
+}
+
+std::string compress(const std::string& data) {
+    std::string out(ZSTD_compressBound(data.size()), '\0');
+    const auto size = ZSTD_compress(out.data(), out.size(), data.data(), data.size(), COMPRESSION_LEVEL);
+    if (ZSTD_isError(size)) {
+        throw std::runtime_error(ZSTD_getErrorName(size));
+    }
+    out.resize(size);
+    return out;
+}
+
+std::string decompress(std::string_view data) {
+    const auto contentSize = ZSTD_getFrameContentSize(data.data(), data.size());
+    if (contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+        throw std::runtime_error("corrupted record");
+    }
+    std::string out(contentSize, '\0');
+    const auto size = ZSTD_decompress(out.data(), out.size(), data.data(), data.size());
+    if (ZSTD_isError(size)) {
+        throw std::runtime_error(ZSTD_getErrorName(size));
+    }
+    out.resize(size);
+    return out;
+}
+
+bool preadAll(int fd, char* data, std::size_t size, std::uint64_t offset) {
+    while (size > 0) {
+        const auto n = pread(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+void writeAll(int fd, std::string_view data, const std::filesystem::path& path) {
+    while (!data.empty()) {
+        const auto n = ::write(fd, data.data(), data.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw std::system_error{ std::error_code{ errno, std::system_category() }, path };
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+}
+
+std::uint64_t fileSize(int fd) {
+    struct stat buf;
+    if (fstat(fd, &buf) != 0) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() } };
+    }
+    return static_cast<std::uint64_t>(buf.st_size);
+}
+
+std::filesystem::path withSuffix(std::filesystem::path path, const char* suffix) {
+    path += suffix;
+    return path;
+}
+
+} // namespace
+
+struct Store::IndexHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t dataInode;
+    std::uint64_t dataSize;
+    std::uint64_t capacity;
+    std::uint64_t count;
+    std::uint64_t liveBytes;
+};
+
+Store::Store(std::filesystem::path path, std::uint64_t maxSize)
+    : mPath(std::move(path))
+    , mIndexPath(withSuffix(mPath, ".idx"))
+    , mLockPath(withSuffix(mPath, ".lock"))
+    , mMaxSize(maxSize) {
+    open();
+    migrate(mPath.parent_path());
+
+    std::lock_guard<std::mutex> guard(mMutex);
+    compactInBackgroundIfNeeded();
+}
+
+Store::~Store() {
+    if (mCompaction.joinable()) {
+        mCompaction.join();
+    }
+    if (mFd >= 0) {
+        ::close(mFd);
+    }
+}
+
+std::filesystem::path Store::defaultPath() {
+    return utils::createCveInfoDir() / "nvd.store";
+}
+
+void Store::open() {
+    std::lock_guard<std::mutex> writeLock(mWriteMutex);
+    FileLock lock(mLockPath);
+    std::lock_guard<std::mutex> guard(mMutex);
+
+    mFd = ::open(mPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (mFd < 0) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, mPath };
+    }
+    DataHeader header{};
+    const auto size = fileSize(mFd);
+    if (size < sizeof(header) || !preadAll(mFd, reinterpret_cast<char*>(&header), sizeof(header), 0) ||
+        std::memcmp(header.magic, DATA_MAGIC, sizeof(DATA_MAGIC)) != 0 || header.version != STORE_VERSION) {
+        if (size > 0) {
+            spdlog::warn("Discarding incompatible NVD cache {}", mPath.string());
+        }
+        if (ftruncate(mFd, 0) != 0) {
+            throw std::system_error{ std::error_code{ errno, std::system_category() }, mPath };
+        }
+        std::memcpy(header.magic, DATA_MAGIC, sizeof(DATA_MAGIC));
+        header.version = STORE_VERSION;
+        writeAll(mFd, { reinterpret_cast<const char*>(&header), sizeof(header) }, mPath);
+    }
+
+    struct stat buf;
+    if (fstat(mFd, &buf) != 0) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, mPath };
+    }
+    mInode = buf.st_ino;
+    loadIndex();
+    scanTail();
+}
+
+void Store::reopenIfReplaced() {
+    // Compaction of another process (or thread) replaces the data file
+    struct stat buf;
+    if (stat(mPath.c_str(), &buf) != 0 || buf.st_ino == mInode) {
+        return;
+    }
+    const int fd = ::open(mPath.c_str(), O_RDWR | O_APPEND | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    ::close(mFd);
+    mFd = fd;
+    mInode = buf.st_ino;
+    loadIndex();
+}
+
+void Store::loadIndex() {
+    mIndex.reset();
+    mTail.clear();
+    mScanned = sizeof(DataHeader);
+    if (!std::filesystem::exists(mIndexPath)) {
+        return;
+    }
+    try {
+        utils::MappedFile index(mIndexPath, utils::MappedFile::Mode::READ_WRITE);
+        IndexHeader header;
+        if (index.size() < sizeof(header)) {
+            return;
+        }
+        std::memcpy(&header, index.data(), sizeof(header));
+        const bool valid = std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+                           header.version == STORE_VERSION && header.dataInode == mInode &&
+                           header.dataSize >= sizeof(DataHeader) && header.dataSize <= fileSize(mFd) &&
+                           header.capacity > 0 && (header.capacity & (header.capacity - 1)) == 0 &&
+                           index.size() == sizeof(header) + header.capacity * sizeof(Slot);
+        if (!valid) {
+            return;
+        }
+        mScanned = header.dataSize;
+        mIndex = std::move(index);
+    } catch (const std::exception& e) {
+        spdlog::warn("Ignoring NVD cache index: {}", e.what());
+    }
+}
+
+void Store::scanTail() {
+    const auto size = fileSize(mFd);
+    const auto now = hoursSinceEpoch(std::chrono::system_clock::now());
+
+    std::string buffer;
+    std::size_t needed = SCAN_CHUNK_SIZE;
+    while (mScanned < size) {
+        buffer.resize(static_cast<std::size_t>(std::min<std::uint64_t>(size - mScanned, needed)));
+        if (!preadAll(mFd, buffer.data(), buffer.size(), mScanned)) {
+            return;
+        }
+        std::size_t pos = 0;
+        bool torn = false;
+        while (pos + sizeof(RecordHeader) <= buffer.size()) {
+            RecordHeader header;
+            std::memcpy(&header, buffer.data() + pos, sizeof(header));
+            const std::size_t total = sizeof(header) + header.keyLength + header.payloadLength;
+            if (header.magic != RECORD_MAGIC) {
+                torn = true;
+                break;
+            }
+            if (pos + total > buffer.size()) {
+                needed = std::max(total, SCAN_CHUNK_SIZE);
+                break;
+            }
+            const std::string_view key(buffer.data() + pos + sizeof(header), header.keyLength);
+            const std::string_view payload(key.data() + key.size(), header.payloadLength);
+            const auto cveId = packedKey(header, key);
+            if (!cveId || checksum(header, key, payload) != header.checksum) {
+                torn = true;
+                break;
+            }
+            mTail[*cveId] = Slot{ *cveId, mScanned + pos, static_cast<std::uint32_t>(total), now };
+            pos += total;
+        }
+        mScanned += pos;
+        // A torn or corrupted record stops the scan, the next writer truncates it
+        if (torn || (pos == 0 && mScanned + needed > size)) {
+            return;
+        }
+    }
+}
+
+bool Store::needsCompaction() const {
+    const auto size = fileSize(mFd);
+    if (size > mMaxSize) {
+        return true;
+    }
+    if (size < MIN_COMPACTION_SIZE) {
+        return false;
+    }
+    std::uint64_t liveBytes = 0;
+    if (mIndex) {
+        IndexHeader header;
+        std::memcpy(&header, mIndex->data(), sizeof(header));
+        liveBytes = header.liveBytes;
+    }
+    for (const auto& [key, slot] : mTail) {
+        liveBytes += slot.size;
+    }
+    return liveBytes < size / 2;
+}
+
+void Store::compactInBackgroundIfNeeded() {
+    if (mCompacting || !needsCompaction()) {
+        return;
+    }
+    // Done with its compaction already, mCompacting is cleared last
+    if (mCompaction.joinable()) {
+        mCompaction.join();
+    }
+    mCompacting = true;
+    mCompaction = std::thread([this] {
+        compact();
+        std::lock_guard<std::mutex> guard(mMutex);
+        mCompacting = false;
+    });
+}
+
+std::vector<Store::Slot> Store::liveSlots() const {
+    std::unordered_map<std::uint64_t, Slot> slots;
+    if (mIndex) {
+        IndexHeader header;
+        std::memcpy(&header, mIndex->data(), sizeof(header));
+        slots.reserve(header.count + mTail.size());
+        const auto* table = reinterpret_cast<const Slot*>(mIndex->data() + sizeof(header));
+        for (std::uint64_t i = 0; i < header.capacity; ++i) {
+            if (table[i].key != 0) {
+                slots.emplace(table[i].key, table[i]);
+            }
+        }
+    }
+    for (const auto& [key, slot] : mTail) {
+        slots[key] = slot;
+    }
+    std::vector<Slot> live;
+    live.reserve(slots.size());
+    for (const auto& [key, slot] : slots) {
+        live.push_back(slot);
+    }
+    return live;
+}
+
+void Store::writeIndexFile(const std::filesystem::path& path,
+                           const std::vector<Slot>& slots,
+                           std::uint64_t dataInode,
+                           std::uint64_t dataSize) {
+    std::uint64_t capacity = 64;
+    while (capacity < slots.size() * 2) {
+        capacity *= 2;
+    }
+    std::vector<Slot> table(capacity, Slot{ 0, 0, 0, 0 });
+    std::uint64_t liveBytes = 0;
+    for (const auto& slot : slots) {
+        auto i = firstSlot(slot.key, capacity);
+        while (table[i].key != 0) {
+            i = (i + 1) & (capacity - 1);
+        }
+        table[i] = slot;
+        liveBytes += slot.size;
+    }
+
+    IndexHeader header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = STORE_VERSION;
+    header.dataInode = dataInode;
+    header.dataSize = dataSize;
+    header.capacity = capacity;
+    header.count = slots.size();
+    header.liveBytes = liveBytes;
+
+    const auto tmpPath = withSuffix(path, ".tmp");
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()),
+                  static_cast<std::streamsize>(table.size() * sizeof(Slot)));
+        if (!out.flush()) {
+            throw std::system_error{ std::error_code{ EIO, std::system_category() }, tmpPath };
+        }
+    }
+    std::filesystem::rename(tmpPath, path);
+}
+
+void Store::writeIndex() {
+    writeIndexFile(mIndexPath, liveSlots(), mInode, mScanned);
+    mIndex.emplace(mIndexPath, utils::MappedFile::Mode::READ_WRITE);
+    mTail.clear();
+}
+
+Store::Slot* Store::findSlot(std::uint64_t key) {
+    if (!mIndex) {
+        return nullptr;
+    }
+    IndexHeader header;
+    std::memcpy(&header, mIndex->data(), sizeof(header));
+    auto* table = reinterpret_cast<Slot*>(mIndex->data() + sizeof(header));
+    auto i = firstSlot(key, header.capacity);
+    for (std::uint64_t probes = 0; probes < header.capacity; ++probes, i = (i + 1) & (header.capacity - 1)) {
+        if (table[i].key == 0) {
+            return nullptr;
+        }
+        if (table[i].key == key) {
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+std::optional<Store::Entry> Store::read(const Slot& slot, CveId cveId) const {
+    std::string buffer(slot.size, '\0');
+    if (slot.size < sizeof(RecordHeader) || !preadAll(mFd, buffer.data(), buffer.size(), slot.offset)) {
+        return std::nullopt;
+    }
+    RecordHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    if (header.magic != RECORD_MAGIC ||
+        sizeof(header) + header.keyLength + header.payloadLength != buffer.size()) {
+        return std::nullopt;
+    }
+    const std::string_view key(buffer.data() + sizeof(header), header.keyLength);
+    const std::string_view payload(key.data() + key.size(), header.payloadLength);
+    // A slot pointing at anything else is left over from a replaced data file
+    if (packedKey(header, key) != cveId.value() || checksum(header, key, payload) != header.checksum) {
+        return std::nullopt;
+    }
+    try {
+        return Entry{ decode(cveId, decompress(payload)),
+                      std::chrono::system_clock::time_point(std::chrono::seconds(header.fetched)),
+                      header.flags };
+    } catch (const std::exception& e) {
+        spdlog::warn("Ignoring corrupted NVD cache record of {}: {}", cveId, e.what());
+        return std::nullopt;
+    }
+}
+
+std::optional<Store::Entry> Store::get(CveId cveId) {
+    const profile::Scope scope("cache.get");
+    try {
+        std::lock_guard<std::mutex> guard(mMutex);
+        reopenIfReplaced();
+        scanTail();
+
+        if (const auto it = mTail.find(cveId.value()); it != std::end(mTail)) {
+            return read(it->second, cveId);
+        }
+        if (auto* slot = findSlot(cveId.value())) {
+            auto entry = read(*slot, cveId);
+            // Least recently used records are evicted first, the access time is updated in place
+            const auto now = hoursSinceEpoch(std::chrono::system_clock::now());
+            if (entry && slot->lastAccess != now) {
+                slot->lastAccess = now;
+            }
+            return entry;
+        }
+    } catch (const std::exception& e) {
+        spdlog::warn("Failed to read {} from the NVD cache: {}", cveId, e.what());
+    }
+    return std::nullopt;
+}
+
+void Store::put(const CveDescription& description,
+                std::chrono::system_clock::time_point fetched,
+                std::uint16_t flags) {
+    append({ description }, fetched, flags);
+}
+
+void Store::put(const std::vector<CveDescription>& descriptions,
+                std::chrono::system_clock::time_point fetched,
+                std::uint16_t flags) {
+    append(descriptions, fetched, flags);
+}
+
+void Store::append(const std::vector<CveDescription>& descriptions,
+                   std::chrono::system_clock::time_point fetched,
+                   std::uint16_t flags) {
+    const profile::Scope scope("cache.put");
+    struct Appended {
+        std::uint64_t key;
+        std::size_t offset;
+        std::size_t size;
+    };
+    std::string buffer;
+    std::vector<Appended> appended;
+    for (const auto& description : descriptions) {
+        if (description.cveId.empty()) {
+            continue;
+        }
+        const auto offset = buffer.size();
+        appendRecord(buffer,
+                     description.cveId.value(),
+                     flags,
+                     std::chrono::duration_cast<std::chrono::seconds>(fetched.time_since_epoch()).count(),
+                     compress(encode(description)));
+        appended.push_back(Appended{ description.cveId.value(), offset, buffer.size() - offset });
+    }
+    if (buffer.empty()) {
+        return;
+    }
+
+    try {
+        std::lock_guard<std::mutex> writeLock(mWriteMutex);
+        FileLock lock(mLockPath);
+        std::lock_guard<std::mutex> guard(mMutex);
+        reopenIfReplaced();
+        scanTail();
+
+        // Drop whatever a crashed writer left behind, it would hide the new records from the tail scans
+        if (fileSize(mFd) > mScanned) {
+            spdlog::warn("Discarding incomplete records of the NVD cache");
+            if (ftruncate(mFd, static_cast<off_t>(mScanned)) != 0) {
+                throw std::system_error{ std::error_code{ errno, std::system_category() }, mPath };
+            }
+        }
+        writeAll(mFd, buffer, mPath);
+
+        const auto now = hoursSinceEpoch(std::chrono::system_clock::now());
+        for (const auto& record : appended) {
+            mTail[record.key] =
+                Slot{ record.key, mScanned + record.offset, static_cast<std::uint32_t>(record.size), now };
+        }
+        mScanned += buffer.size();
+
+        IndexHeader header{};
+        header.dataSize = sizeof(DataHeader);
+        if (mIndex) {
+            std::memcpy(&header, mIndex->data(), sizeof(header));
+        }
+        if (mScanned - header.dataSize > MAX_TAIL_SIZE) {
+            writeIndex();
+        }
+        // Long-lived stores (the server, a long sync) keep growing after they were opened
+        compactInBackgroundIfNeeded();
+    } catch (const std::exception& e) {
+        spdlog::warn("Failed to write to the NVD cache: {}", e.what());
+    }
+}
+
+void Store::compact() {
+    try {
+        std::lock_guard<std::mutex> writeLock(mWriteMutex);
+        FileLock lock(mLockPath);
+
+        std::vector<Slot> slots;
+        std::uint64_t sourceSize;
+        int sourceFd;
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            reopenIfReplaced();
+            scanTail();
+            slots = liveSlots();
+            sourceSize = mScanned;
+            sourceFd = dup(mFd);
+            if (sourceFd < 0) {
+                throw std::system_error{ std::error_code{ errno, std::system_category() }, mPath };
+            }
+        }
+
+        // Keep the most recently used records, then the most recently written ones (access times are in
+        // hours), leaving some room below the limit for new ones
+        std::sort(std::begin(slots), std::end(slots), [](const Slot& lhs, const Slot& rhs) {
+            if (lhs.lastAccess != rhs.lastAccess) {
+                return lhs.lastAccess > rhs.lastAccess;
+            }
+            return lhs.offset > rhs.offset;
+        });
+        std::uint64_t liveBytes = 0;
+        for (const auto& slot : slots) {
+            liveBytes += slot.size;
+        }
+        if (liveBytes + sizeof(DataHeader) > mMaxSize) {
+            const auto budget = mMaxSize / 4 * 3;
+            std::uint64_t kept = 0;
+            const auto last = std::find_if(std::begin(slots), std::end(slots), [&](const Slot& slot) {
+                kept += slot.size;
+                return kept > budget;
+            });
+            spdlog::debug("Evicting {} least recently used records from the NVD cache",
+                          std::distance(last, std::end(slots)));
+            slots.erase(last, std::end(slots));
+        }
+        // Copying in file order keeps the reads sequential
+        std::sort(std::begin(slots), std::end(slots), [](const Slot& lhs, const Slot& rhs) {
+            return lhs.offset < rhs.offset;
+        });
+
+        const auto tmpPath = withSuffix(mPath, ".compact");
+        const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            ::close(sourceFd);
+            throw std::system_error{ std::error_code{ errno, std::system_category() }, tmpPath };
+        }
+        std::uint64_t inode = 0;
+        std::uint64_t size = 0;
+        try {
+            DataHeader dataHeader{};
+            std::memcpy(dataHeader.magic, DATA_MAGIC, sizeof(DATA_MAGIC));
+            dataHeader.version = STORE_VERSION;
+            std::string buffer(reinterpret_cast<const char*>(&dataHeader), sizeof(dataHeader));
+            size = buffer.size();
+            std::string record;
+            for (auto& slot : slots) {
+                record.resize(slot.size);
+                if (!preadAll(sourceFd, record.data(), record.size(), slot.offset)) {
+                    throw std::runtime_error("failed to read record");
+                }
+                slot.offset = size;
+                size += record.size();
+                buffer += record;
+                if (buffer.size() >= SCAN_CHUNK_SIZE) {
+                    writeAll(fd, buffer, tmpPath);
+                    buffer.clear();
+                }
+            }
+            writeAll(fd, buffer, tmpPath);
+            struct stat buf;
+            if (fstat(fd, &buf) != 0) {
+                throw std::system_error{ std::error_code{ errno, std::system_category() }, tmpPath };
+            }
+            inode = buf.st_ino;
+        } catch (...) {
+            ::close(fd);
+            ::close(sourceFd);
+            std::filesystem::remove(tmpPath);
+            throw;
+        }
+        ::close(fd);
+        ::close(sourceFd);
+
+        const auto tmpIndexPath = withSuffix(mIndexPath, ".compact");
+        writeIndexFile(tmpIndexPath, slots, inode, size);
+
+        std::lock_guard<std::mutex> guard(mMutex);
+        std::filesystem::rename(tmpIndexPath, mIndexPath);
+        std::filesystem::rename(tmpPath, mPath);
+        reopenIfReplaced();
+        scanTail();
+        spdlog::debug("Compacted NVD cache from {} to {} bytes", sourceSize, size);
+    } catch (const std::exception& e) {
+        spdlog::warn("Failed to compact the NVD cache: {}", e.what());
+    }
+}
+
+void Store::exportTo(const std::filesystem::path& data, const std::filesystem::path& index) {
+    std::lock_guard<std::mutex> writeLock(mWriteMutex);
+    FileLock lock(mLockPath);
+    std::lock_guard<std::mutex> guard(mMutex);
+    reopenIfReplaced();
+    scanTail();
+
+    const int fd = ::open(data.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, data };
+    }
+    try {
+        std::string buffer;
+        for (std::uint64_t offset = 0; offset < mScanned; offset += buffer.size()) {
+            const auto chunk = std::min<std::uint64_t>(mScanned - offset, SCAN_CHUNK_SIZE);
+            buffer.resize(static_cast<std::size_t>(chunk));
+            if (!preadAll(mFd, buffer.data(), buffer.size(), offset)) {
+                throw std::runtime_error("failed to read the NVD cache");
+            }
+            writeAll(fd, buffer, data);
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    // The inode of the copy is only known once it's imported
+    writeIndexFile(index, liveSlots(), 0, mScanned);
+}
+
+void Store::importFrom(const std::filesystem::path& data, const std::filesystem::path& index) {
+    std::uint64_t inode = 0;
+    {
+        const int fd = ::open(data.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error{ std::error_code{ errno, std::system_category() }, data };
+        }
+        DataHeader header{};
+        struct stat buf;
+        const bool valid = preadAll(fd, reinterpret_cast<char*>(&header), sizeof(header), 0) &&
+                           std::memcmp(header.magic, DATA_MAGIC, sizeof(DATA_MAGIC)) == 0 &&
+                           header.version == STORE_VERSION && fstat(fd, &buf) == 0;
+        ::close(fd);
+        if (!valid) {
+            throw std::runtime_error("incompatible NVD cache " + data.string());
+        }
+        inode = buf.st_ino;
+    }
+    // Binds the index to the imported data file, an index that doesn't fit is rebuilt by scanning the file
+    if (std::filesystem::exists(index)) {
+        utils::MappedFile mapped(index, utils::MappedFile::Mode::READ_WRITE);
+        IndexHeader header;
+        if (mapped.size() >= sizeof(header)) {
+            std::memcpy(&header, mapped.data(), sizeof(header));
+            header.dataInode = inode;
+            std::memcpy(mapped.data(), &header, sizeof(header));
+        }
+    }
+
+    std::lock_guard<std::mutex> writeLock(mWriteMutex);
+    FileLock lock(mLockPath);
+    std::lock_guard<std::mutex> guard(mMutex);
+    if (std::filesystem::exists(index)) {
+        std::filesystem::rename(index, mIndexPath);
+    } else {
+        std::filesystem::remove(mIndexPath);
+    }
+    std::filesystem::rename(data, mPath);
+    reopenIfReplaced();
+    scanTail();
+}
+
+void Store::migrate(const std::filesystem::path& directory) {
+    std::size_t migrated = 0;
+    try {
+        // Full NVD responses cached by older versions, one file per CVE
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            const auto name = entry.path().filename().string();
+            const auto cveId = CveId::parse(name);
+            if (!entry.is_regular_file() || !cveId) {
+                continue;
+            }
+            try {
+                const auto response = json::parse(std::ifstream(entry.path()));
+                if (const auto* cve = schema::FIRST_CVE.find(response)) {
+                    auto description = parseCve(*cve);
+                    description.cveId = *cveId;
+                    put(description, utils::lastWriteTime(entry.path()));
+                    ++migrated;
+                }
+            } catch (const std::exception& e) {
+                spdlog::warn("Dropping unreadable NVD cache file {}: {}", entry.path().string(), e.what());
+            }
+            std::error_code ec;
+            std::filesystem::remove(entry.path(), ec);
+        }
+    } catch (const std::exception& e) {
+        spdlog::warn("Failed to migrate the NVD cache: {}", e.what());
+    }
+    if (migrated > 0) {
+        spdlog::info("Migrated {} cached NVD records to {}", migrated, mPath.string());
+    }
+}
@@ -0,0 +1,419 @@
+#include "cveinfo/cve/PackageResolver.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <optional>
+#include <span>
+
+using namespace cveinfo::debian;
+
+namespace {
+
+constexpr float KNOWN = 0.95f;
+constexpr float DERIVED = 0.9f;
+constexpr float DERIVED_STEP = 0.01f;
+
+struct KnownSource {
+    std::string_view binary;
+    std::string_view source;
+};
+
+// Binary package names, or their forms without affixes and soname versions, built from a differently named
+// source package. Sorted by binary package name.
+constexpr auto KNOWN_SOURCES = std::to_array<KnownSource>({
+    { "bind9-host", "bind9" },
+    { "bind9-libs", "bind9" },
+    { "bsdutils", "util-linux" },
+    { "dirmngr", "gnupg2" },
+    { "dnsutils", "bind9" },
+    { "gpg", "gnupg2" },
+    { "gpg-agent", "gnupg2" },
+    { "gpgv", "gnupg2" },
+    { "libacl", "acl" },
+    { "libapt-pkg", "apt" },
+    { "libattr", "attr" },
+    { "libaudit", "audit" },
+    { "libblkid", "util-linux" },
+    { "libbrotli", "brotli" },
+    { "libbz2", "bzip2" },
+    { "libc", "glibc" },
+    { "libc-bin", "glibc" },
+    { "libcom-err", "e2fsprogs" },
+    { "libcrypt", "libxcrypt" },
+    { "libcrypto", "openssl" },
+    { "libcurl", "curl" },
+    { "libdebconfclient", "cdebconf" },
+    { "libdw", "elfutils" },
+    { "libelf", "elfutils" },
+    { "libexpat", "expat" },
+    { "libext2fs", "e2fsprogs" },
+    { "libfdisk", "util-linux" },
+    { "libfreetype", "freetype" },
+    { "libgdbm", "gdbm" },
+    { "libglib", "glib2.0" },
+    { "libgnutls", "gnutls28" },
+    { "libgssapi-krb5", "krb5" },
+    { "libhistory", "readline" },
+    { "libhogweed", "nettle" },
+    { "libicu", "icu" },
+    { "libjpeg62-turbo", "libjpeg-turbo" },
+    { "libk5crypto", "krb5" },
+    { "libkeyutils", "keyutils" },
+    { "libkrb5", "krb5" },
+    { "libldap", "openldap" },
+    { "liblz4", "lz4" },
+    { "liblzma", "xz-utils" },
+    { "libmount", "util-linux" },
+    { "libncurses", "ncurses" },
+    { "libncursesw", "ncurses" },
+    { "libnettle", "nettle" },
+    { "libnghttp2", "nghttp2" },
+    { "libnspr", "nspr" },
+    { "libnss", "nss" },
+    { "libp11-kit", "p11-kit" },
+    { "libpam", "pam" },
+    { "libpam-modules", "pam" },
+    { "libpam-runtime", "pam" },
+    { "libpcre", "pcre3" },
+    { "libpcre2", "pcre2" },
+    { "libperl", "perl" },
+    { "libpng", "libpng1.6" },
+    { "libproc2", "procps" },
+    { "libprocps", "procps" },
+    { "libreadline", "readline" },
+    { "librtmp", "rtmpdump" },
+    { "libsasl2", "cyrus-sasl2" },
+    { "libsmartcols", "util-linux" },
+    { "libsqlite", "sqlite3" },
+    { "libss", "e2fsprogs" },
+    { "libssl", "openssl" },
+    { "libsystemd", "systemd" },
+    { "libsystemd-shared", "systemd" },
+    { "libtiff", "tiff" },
+    { "libtinfo", "ncurses" },
+    { "libudev", "systemd" },
+    { "libuuid", "util-linux" },
+    { "libxxhash", "xxhash" },
+    { "linux-libc", "linux" },
+    { "locales", "glibc" },
+    { "login", "shadow" },
+    { "mount", "util-linux" },
+    { "ncurses-base", "ncurses" },
+    { "ncurses-bin", "ncurses" },
+    { "openssh-client", "openssh" },
+    { "openssh-server", "openssh" },
+    { "passwd", "shadow" },
+    { "perl-base", "perl" },
+    { "perl-modules", "perl" },
+    { "sysvinit-utils", "sysvinit" },
+    { "udev", "systemd" },
+    { "zlib1g", "zlib" },
+});
+static_assert(std::is_sorted(std::begin(KNOWN_SOURCES),
+                             std::end(KNOWN_SOURCES),
+                             [](const auto& lhs, const auto& rhs) { return lhs.binary < rhs.binary; }));
+
+// Prefixes of versioned binary packages, e.g. linux-image-6.1.0-18-amd64
+constexpr std::array<KnownSource, 3> KNOWN_PREFIXES = { {
+    { "linux-headers-", "linux" },
+    { "linux-image-", "linux" },
+    { "linux-kbuild-", "linux" },
+} };
+
+// Suffixes of binary packages named after their source package, stripped one after the other
+constexpr std::array<std::string_view, 13> BINARY_SUFFIXES = {
+    "-dev", "-dbg", "-dbgsym", "-doc", "-common", "-data", "-bin", "-utils", "-tools", "-examples", "-udeb",
+    "-runtime", "t64",
+};
+
+std::optional<std::string_view> knownSource(std::string_view binary) {
+    const auto it = std::lower_bound(std::begin(KNOWN_SOURCES),
+                                     std::end(KNOWN_SOURCES),
+                                     binary,
+                                     [](const KnownSource& known, std::string_view name) {
+                                         return known.binary < name;
+                                     });
+    if (it == std::end(KNOWN_SOURCES) || it->binary != binary) {
+        return std::nullopt;
+    }
+    return it->source;
+}
+
+std::string normalize(std::string_view packageName) {
+    // An architecture qualifier, e.g. libc6:amd64
+    packageName = packageName.substr(0, packageName.find(':'));
+    std::string name(packageName);
+    std::transform(std::begin(name), std::end(name), std::begin(name), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return name;
+}
+
+/// Strips one trailing soname version, e.g. libpcre2-8-0 to libpcre2-8, returns false if there's none.
+bool stripVersion(std::string& name) {
+    auto end = name.find_last_not_of("0123456789.");
+    if (end == std::string::npos || end + 1 == name.size()) {
+        return false;
+    }
+    // The separator of libfoo-1 or libfoo2.0-0
+    if (name[end] == '-' && end > 0) {
+        --end;
+    }
+    if (end < 1) {
+        return false;
+    }
+    name.resize(end + 1);
+    return true;
+}
+
+std::vector<std::uint32_t> trigrams(std::string_view name) {
+    // Padded, so short names and the first and last letters count as well
+    std::string padded = "^";
+    padded += name;
+    padded += '$';
+    std::vector<std::uint32_t> result;
+    result.reserve(padded.size());
+    for (std::size_t i = 0; i + 3 <= padded.size(); ++i) {
+        result.push_back(static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i])) << 16 |
+                         static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8 |
+                         static_cast<unsigned char>(padded[i + 2]));
+    }
+    std::sort(std::begin(result), std::end(result));
+    result.erase(std::unique(std::begin(result), std::end(result)), std::end(result));
+    return result;
+}
+
+} // namespace
+
+PackageResolver::Query::Query(std::string_view packageName) {
+    const auto name = normalize(packageName);
+    std::vector<std::string> forms;
+    forms.reserve(8);
+    const auto addForm = [&forms](std::string form) {
+        if (!form.empty() && std::find(std::begin(forms), std::end(forms), form) == std::end(forms)) {
+            forms.push_back(std::move(form));
+        }
+    };
+    addForm(name);
+    if (forms.empty()) {
+        return;
+    }
+
+    // foo-dev, libfoo1t64, ...
+    std::string stem = name;
+    for (bool stripped = true; stripped;) {
+        stripped = false;
+        for (const auto suffix : BINARY_SUFFIXES) {
+            if (stem.size() > suffix.size() + 1 && stem.ends_with(suffix)) {
+                stem.resize(stem.size() - suffix.size());
+                addForm(stem);
+                stripped = true;
+                break;
+            }
+        }
+    }
+    // python3-foo is built from python-foo or just foo
+    for (const std::string_view prefix : { "python3-", "python-" }) {
+        if (stem.starts_with(prefix) && stem.size() > prefix.size()) {
+            if (prefix == "python3-") {
+                addForm("python-" + stem.substr(prefix.size()));
+            }
+            addForm(stem.substr(prefix.size()));
+            break;
+        }
+    }
+    // Shared libraries carry their soname version, libfoo2-1 comes from libfoo2 or libfoo
+    for (std::string unversioned = stem; stripVersion(unversioned);) {
+        addForm(unversioned);
+        if (unversioned.starts_with("lib") && unversioned.size() > 4 &&
+            unversioned.find_first_of("0123456789.-") == std::string::npos) {
+            addForm(unversioned.substr(3));
+        }
+    }
+
+    mDerived.reserve(forms.size() + 2);
+    mDerived.emplace_back(forms.front(), EXACT);
+    // The mapping of the most specific form wins, libpcre2-8-0 is built from pcre2 rather than pcre3
+    for (std::size_t i = 0; i < forms.size(); ++i) {
+        if (const auto source = knownSource(forms[i])) {
+            mDerived.emplace_back(*source, std::max(KNOWN - static_cast<float>(i) * DERIVED_STEP, DERIVED));
+        }
+    }
+    for (const auto& [prefix, source] : KNOWN_PREFIXES) {
+        if (name.starts_with(prefix)) {
+            mDerived.emplace_back(source, KNOWN);
+        }
+    }
+    for (std::size_t i = 1; i < forms.size(); ++i) {
+        const auto score = DERIVED - static_cast<float>(i - 1) * DERIVED_STEP;
+        mDerived.emplace_back(forms[i], std::max(score, FUZZY + DERIVED_STEP));
+    }
+
+    mStem = std::move(stem);
+}
+
+float PackageResolver::Query::score(std::string_view candidate) const {
+    float best = 0;
+    for (const auto& [name, score] : mDerived) {
+        if (name == candidate) {
+            best = std::max(best, score);
+        }
+    }
+    if (best > 0) {
+        return best;
+    }
+    const auto stemTrigrams = trigrams(mStem);
+    const auto candidateTrigrams = trigrams(candidate);
+    std::size_t shared = 0;
+    for (auto lhs = std::begin(stemTrigrams), rhs = std::begin(candidateTrigrams);
+         lhs != std::end(stemTrigrams) && rhs != std::end(candidateTrigrams);) {
+        if (*lhs < *rhs) {
+            ++lhs;
+        } else if (*rhs < *lhs) {
+            ++rhs;
+        } else {
+            ++shared;
+            ++lhs;
+            ++rhs;
+        }
+    }
+    return fuzzyScore(candidate, stemTrigrams.size(), shared, candidateTrigrams.size());
+}
+
+float PackageResolver::Query::fuzzyScore(std::string_view candidate,
+                                         std::size_t stemTrigrams,
+                                         std::size_t shared,
+                                         std::size_t candidateTrigrams) const {
+    if (shared == 0) {
+        return 0;
+    }
+    // Dice coefficient of the trigram sets
+    auto similarity =
+        2 * static_cast<float>(shared) / static_cast<float>(stemTrigrams + candidateTrigrams);
+
+    // One name containing the other shares all its inner trigrams, anything else can't
+    const auto smaller = std::min(stemTrigrams, candidateTrigrams);
+    if (shared + 2 >= smaller) {
+        const std::string_view stem = mStem;
+        const auto shorter = std::min(stem.size(), candidate.size());
+        const auto longer = std::max(stem.size(), candidate.size());
+        if (candidate.find(stem) != std::string_view::npos ||
+            stem.find(candidate) != std::string_view::npos) {
+            similarity = std::max(similarity, static_cast<float>(shorter) / static_cast<float>(longer));
+        }
+    }
+    return FUZZY * similarity;
+}
+
+PackageResolver::PackageResolver(std::vector<std::string_view> names)
+    : mNames(std::move(names)) {
+    mIds.reserve(mNames.size());
+    mTrigramCounts.reserve(mNames.size());
+    for (std::uint32_t id = 0; id < mNames.size(); ++id) {
+        mIds.emplace(mNames[id], id);
+        const auto nameTrigrams = trigrams(mNames[id]);
+        mTrigramCounts.push_back(
+            static_cast<std::uint16_t>(std::min<std::size_t>(nameTrigrams.size(), 0xffff)));
+        for (const auto trigram : nameTrigrams) {
+            mPostings.emplace_back(trigram, id);
+        }
+    }
+    std::sort(std::begin(mPostings), std::end(mPostings));
+}
+
+std::vector<PackageResolver::Match> PackageResolver::resolve(std::string_view packageName,
+                                                             std::size_t limit) const {
+    if (limit == 0) {
+        return {};
+    }
+    // The common case of a source package name needs no further ranking
+    if (const auto it = mIds.find(packageName); limit == 1 && it != std::end(mIds)) {
+        return { Match{ mNames[it->second], EXACT } };
+    }
+
+    const Query query(packageName);
+    std::vector<Match> matches;
+    for (const auto& [name, score] : query.mDerived) {
+        const auto it = mIds.find(name);
+        const auto matched = [&](const Match& match) { return match.name == name; };
+        if (it != std::end(mIds) && std::none_of(std::begin(matches), std::end(matches), matched)) {
+            matches.push_back(Match{ mNames[it->second], score });
+        }
+    }
+    if (matches.size() >= limit) {
+        matches.resize(limit);
+        return matches;
+    }
+
+    // A name needs this many trigrams in common with the query to reach MIN_SCORE, so it has to be in one
+    // of the (trigrams - minShared + 1) rarest posting lists: candidates are collected from those and only
+    // looked up in the common ones, which are often a large part of the index (e.g. "lib")
+    using Postings = std::span<const std::pair<std::uint32_t, std::uint32_t>>;
+    std::vector<Postings> lists;
+    const auto stemTrigrams = trigrams(query.mStem);
+    lists.reserve(stemTrigrams.size());
+    for (const auto trigram : stemTrigrams) {
+        const auto first =
+            std::lower_bound(std::begin(mPostings), std::end(mPostings), std::pair(trigram, 0U));
+        const auto last = std::lower_bound(first, std::end(mPostings), std::pair(trigram + 1, 0U));
+        if (first != last) {
+            lists.emplace_back(first, last);
+        }
+    }
+    std::sort(std::begin(lists), std::end(lists), [](const Postings& lhs, const Postings& rhs) {
+        return lhs.size() < rhs.size();
+    });
+    constexpr float MIN_SIMILARITY = MIN_SCORE / FUZZY;
+    // From 2 * shared / (trigrams + nameTrigrams) >= MIN_SIMILARITY and shared <= nameTrigrams
+    const auto bound = MIN_SIMILARITY * static_cast<float>(stemTrigrams.size()) / (2 - MIN_SIMILARITY);
+    const auto minShared = std::max<std::size_t>(static_cast<std::size_t>(std::ceil(bound - 1e-3f)), 1);
+    const auto candidateLists = lists.size() >= minShared ? lists.size() - minShared + 1 : 0;
+
+    // Reuses the counters of the thread, they're reset while scoring
+    thread_local std::vector<std::uint16_t> shared;
+    thread_local std::vector<std::uint32_t> touched;
+    if (shared.size() < mNames.size()) {
+        shared.resize(mNames.size());
+    }
+    for (std::size_t i = 0; i < candidateLists; ++i) {
+        for (const auto& [trigram, id] : lists[i]) {
+            if (shared[id]++ == 0) {
+                touched.push_back(id);
+            }
+        }
+    }
+    for (std::size_t i = candidateLists; i < lists.size(); ++i) {
+        for (const auto id : touched) {
+            const auto posting = std::pair(lists[i].front().first, id);
+            shared[id] += std::binary_search(std::begin(lists[i]), std::end(lists[i]), posting);
+        }
+    }
+
+    std::vector<Match> fuzzy;
+    for (const auto id : touched) {
+        const auto count = std::exchange(shared[id], 0);
+        if (count < minShared) {
+            continue;
+        }
+        const auto name = mNames[id];
+        const auto score = query.fuzzyScore(name, stemTrigrams.size(), count, mTrigramCounts[id]);
+        const auto matched = [&](const Match& match) { return match.name == name; };
+        if (score >= MIN_SCORE && std::none_of(std::begin(matches), std::end(matches), matched)) {
+            fuzzy.push_back(Match{ name, score });
+        }
+    }
+    touched.clear();
+
+    const auto count = std::min(fuzzy.size(), limit - matches.size());
+    std::partial_sort(std::begin(fuzzy),
+                      std::begin(fuzzy) + static_cast<std::ptrdiff_t>(count),
+                      std::end(fuzzy),
+                      [](const Match& lhs, const Match& rhs) {
+                          return lhs.score != rhs.score ? lhs.score > rhs.score : lhs.name < rhs.name;
+                      });
+    matches.insert(
+        std::end(matches), std::begin(fuzzy), std::begin(fuzzy) + static_cast<std::ptrdiff_t>(count));
+    return matches;
+}
@@ -0,0 +1,327 @@
+#include "cveinfo/cve/TrackerIndex.hpp"
+
+#include "cveinfo/profile.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace cveinfo;
+using debian::TrackerIndex;
+
+namespace {
+
+constexpr char INDEX_MAGIC[8] = { 'C', 'V', 'E', 'I', 'D', 'X', '\0', '\0' };
+constexpr std::uint32_t INDEX_VERSION = 5;
+
+std::string_view readString(std::string_view strings, std::uint32_t offset) {
+    std::uint32_t length;
+    std::memcpy(&length, strings.data() + offset, sizeof(length));
+    return strings.substr(offset + sizeof(length), length);
+}
+
+template <typename T>
+void writeTable(std::ostream& out, const std::vector<T>& table) {
+    out.write(reinterpret_cast<const char*>(table.data()),
+              static_cast<std::streamsize>(table.size() * sizeof(T)));
+}
+
+} // namespace
+
+TrackerIndex::SourceStamp TrackerIndex::SourceStamp::of(const std::filesystem::path& source) {
+    struct stat buf;
+    if (stat(source.c_str(), &buf) != 0) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, source };
+    }
+    return SourceStamp{ static_cast<std::uint64_t>(buf.st_size),
+                        std::int64_t(buf.st_mtim.tv_sec) * 1'000'000'000 + buf.st_mtim.tv_nsec };
+}
+
+std::uint32_t TrackerIndex::Builder::intern(std::string_view str) {
+    auto it = mStringIds.find(str);
+    if (it != std::end(mStringIds)) {
+        return it->second;
+    }
+    const auto offset = static_cast<std::uint32_t>(mStrings.size());
+    const auto length = static_cast<std::uint32_t>(str.size());
+    mStrings.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    mStrings.append(str);
+    mStringIds.emplace(str, offset);
+    return offset;
+}
+
+std::string_view TrackerIndex::Builder::string(std::uint32_t offset) const {
+    return readString(mStrings, offset);
+}
+
+void TrackerIndex::Builder::addRecord(std::string_view package, CveId cveId, bool hasReleases) {
+    Record record{ intern(package),
+                   static_cast<std::uint32_t>(mReleases.size()),
+                   0,
+                   hasReleases ? Record::HAS_RELEASES : 0 };
+    mRecords.push_back(PendingRecord{ cveId, record });
+}
+
+void TrackerIndex::Builder::addRelease(std::string_view codename,
+                                       std::optional<std::string_view> status,
+                                       std::optional<std::string_view> fixedVersion) {
+    if (mRecords.empty()) {
+        return;
+    }
+    mReleases.push_back(Release{ intern(codename),
+                                 status ? intern(*status) : NO_STRING,
+                                 fixedVersion ? intern(*fixedVersion) : NO_STRING });
+    ++mRecords.back().record.releaseCount;
+}
+
+void TrackerIndex::Builder::setSourceHash(std::string_view package, std::uint64_t hash) {
+    mSourceHashes.insert_or_assign(std::string(package), hash);
+}
+
+void TrackerIndex::Builder::copyPackage(const TrackerIndex& index,
+                                        std::size_t package,
+                                        std::optional<std::string_view> codename) {
+    const auto name = index.packageName(package);
+    for (const auto& packageRecord : index.packageRecords(package)) {
+        const auto& record = index.record(packageRecord);
+        addRecord(name, index.cveId(packageRecord), record.flags & Record::HAS_RELEASES);
+        for (const auto& release : index.releases(record)) {
+            if (codename && index.string(release.codename) != *codename) {
+                continue;
+            }
+            addRelease(index.string(release.codename),
+                       index.optionalString(release.status),
+                       index.optionalString(release.fixedVersion));
+        }
+    }
+    setSourceHash(name, index.sourceHash(package));
+}
+
+void TrackerIndex::Builder::append(const Builder& other) {
+    // Interning the strings of other again would take about as long as parsing them did, they're copied
+    // as they are instead. write() groups the records by content, so a string interned by both builders
+    // merely takes its space twice.
+    const auto stringBase = static_cast<std::uint32_t>(mStrings.size());
+    const auto releaseBase = static_cast<std::uint32_t>(mReleases.size());
+    mStrings += other.mStrings;
+    const auto rebase = [stringBase](std::uint32_t offset) {
+        return offset == NO_STRING ? NO_STRING : offset + stringBase;
+    };
+
+    mRecords.reserve(mRecords.size() + other.mRecords.size());
+    for (const auto& pending : other.mRecords) {
+        Record record = pending.record;
+        record.package = rebase(record.package);
+        record.firstRelease += releaseBase;
+        mRecords.push_back(PendingRecord{ pending.cveId, record });
+    }
+    mReleases.reserve(mReleases.size() + other.mReleases.size());
+    for (const auto& release : other.mReleases) {
+        mReleases.push_back(
+            Release{ rebase(release.codename), rebase(release.status), rebase(release.fixedVersion) });
+    }
+    for (const auto& [package, hash] : other.mSourceHashes) {
+        mSourceHashes.insert_or_assign(package, hash);
+    }
+}
+
+void TrackerIndex::Builder::write(const std::filesystem::path& indexPath, const SourceStamp& source) const {
+    // CVEs by ID, then packages and releases by name like in the JSON database
+    std::vector<std::size_t> order(mRecords.size());
+    std::iota(std::begin(order), std::end(order), 0);
+    std::stable_sort(std::begin(order), std::end(order), [this](std::size_t lhs, std::size_t rhs) {
+        const auto& l = mRecords[lhs];
+        const auto& r = mRecords[rhs];
+        if (l.cveId != r.cveId) {
+            return l.cveId < r.cveId;
+        }
+        return string(l.record.package) < string(r.record.package);
+    });
+
+    std::vector<CveEntry> cves;
+    std::vector<Record> records;
+    std::vector<Release> releases;
+    records.reserve(mRecords.size());
+    releases.reserve(mReleases.size());
+    for (const auto i : order) {
+        const auto& pending = mRecords[i];
+        if (cves.empty() || cves.back().cveId() != pending.cveId) {
+            cves.push_back(CveEntry{ pending.cveId.value(), static_cast<std::uint32_t>(records.size()), 0 });
+        }
+        ++cves.back().recordCount;
+
+        Record record = pending.record;
+        record.firstRelease = static_cast<std::uint32_t>(releases.size());
+        const auto first = std::begin(mReleases) + pending.record.firstRelease;
+        releases.insert(std::end(releases), first, first + pending.record.releaseCount);
+        std::stable_sort(std::begin(releases) + record.firstRelease,
+                         std::end(releases),
+                         [this](const Release& l, const Release& r) {
+                             return string(l.codename) < string(r.codename);
+                         });
+        records.push_back(record);
+    }
+
+    // Records are ordered by CVE already, a stable sort by package keeps the CVEs of a package ordered
+    std::vector<std::uint32_t> cveOf(records.size());
+    for (std::uint32_t cve = 0; cve < cves.size(); ++cve) {
+        std::fill_n(std::begin(cveOf) + cves[cve].firstRecord, cves[cve].recordCount, cve);
+    }
+    std::vector<std::uint32_t> byPackage(records.size());
+    std::iota(std::begin(byPackage), std::end(byPackage), 0);
+    std::stable_sort(std::begin(byPackage), std::end(byPackage), [&](std::uint32_t lhs, std::uint32_t rhs) {
+        return records[lhs].package != records[rhs].package &&
+               string(records[lhs].package) < string(records[rhs].package);
+    });
+    std::vector<PackageEntry> packages;
+    std::vector<PackageRecord> packageRecords;
+    packageRecords.reserve(records.size());
+    for (const auto i : byPackage) {
+        if (packages.empty() || string(packages.back().name) != string(records[i].package)) {
+            const auto it = mSourceHashes.find(string(records[i].package));
+            const auto hash = it != std::end(mSourceHashes) ? it->second : 0;
+            packages.push_back(PackageEntry{ records[i].package,
+                                             static_cast<std::uint32_t>(packageRecords.size()),
+                                             0,
+                                             static_cast<std::uint32_t>(hash),
+                                             static_cast<std::uint32_t>(hash >> 32) });
+        }
+        ++packages.back().recordCount;
+        packageRecords.push_back(PackageRecord{ cveOf[i], i });
+    }
+
+    Header header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.version = INDEX_VERSION;
+    header.sourceSize = source.size;
+    header.sourceMtime = source.mtime;
+    header.cveCount = static_cast<std::uint32_t>(cves.size());
+    header.recordCount = static_cast<std::uint32_t>(records.size());
+    header.releaseCount = static_cast<std::uint32_t>(releases.size());
+    header.stringsSize = static_cast<std::uint32_t>(mStrings.size());
+    header.packageCount = static_cast<std::uint32_t>(packages.size());
+
+    // Processes indexing the same database concurrently must not write into each other's file
+    auto tmpPath = indexPath;
+    tmpPath += ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeTable(out, cves);
+        writeTable(out, records);
+        writeTable(out, releases);
+        writeTable(out, packages);
+        writeTable(out, packageRecords);
+        out.write(mStrings.data(), static_cast<std::streamsize>(mStrings.size()));
+        if (!out.flush()) {
+            throw std::system_error{ std::error_code{ EIO, std::system_category() }, tmpPath };
+        }
+    }
+    std::filesystem::rename(tmpPath, indexPath);
+}
+
+TrackerIndex::TrackerIndex(utils::MappedFile file)
+    : mFile(std::move(file)) {
+    Header header;
+    std::memcpy(&header, mFile.data(), sizeof(header));
+    const char* data = mFile.data() + sizeof(header);
+    static_assert(sizeof(Header) % alignof(CveEntry) == 0);
+    mCves = { reinterpret_cast<const CveEntry*>(data), header.cveCount };
+    data += header.cveCount * sizeof(CveEntry);
+    mRecords = { reinterpret_cast<const Record*>(data), header.recordCount };
+    data += header.recordCount * sizeof(Record);
+    mReleases = { reinterpret_cast<const Release*>(data), header.releaseCount };
+    data += header.releaseCount * sizeof(Release);
+    mPackages = { reinterpret_cast<const PackageEntry*>(data), header.packageCount };
+    data += header.packageCount * sizeof(PackageEntry);
+    mPackageRecords = { reinterpret_cast<const PackageRecord*>(data), header.recordCount };
+    data += header.recordCount * sizeof(PackageRecord);
+    mStrings = { data, header.stringsSize };
+}
+
+std::optional<TrackerIndex> TrackerIndex::open(const std::filesystem::path& indexPath,
+                                               const std::optional<SourceStamp>& source) {
+    const profile::Scope scope("tracker.open");
+    try {
+        if (!std::filesystem::exists(indexPath)) {
+            return std::nullopt;
+        }
+        utils::MappedFile file(indexPath);
+        Header header;
+        if (file.size() < sizeof(header)) {
+            spdlog::warn("Ignoring corrupted debian security tracker index {}", indexPath.string());
+            return std::nullopt;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != INDEX_VERSION) {
+            return std::nullopt;
+        }
+        const std::size_t expectedSize = sizeof(header) + header.cveCount * sizeof(CveEntry) +
+                                         header.recordCount * sizeof(Record) +
+                                         header.releaseCount * sizeof(Release) +
+                                         header.packageCount * sizeof(PackageEntry) +
+                                         header.recordCount * sizeof(PackageRecord) + header.stringsSize;
+        if (file.size() != expectedSize) {
+            spdlog::warn("Ignoring corrupted debian security tracker index {}", indexPath.string());
+            return std::nullopt;
+        }
+        if (source && SourceStamp{ header.sourceSize, header.sourceMtime } != *source) {
+            return std::nullopt;
+        }
+        return TrackerIndex(std::move(file));
+    } catch (const std::exception& e) {
+        spdlog::warn("Failed to open debian security tracker index: {}", e.what());
+        return std::nullopt;
+    }
+}
+
+std::span<const TrackerIndex::Record> TrackerIndex::find(CveId cveId) const {
+    const auto it = std::lower_bound(
+        std::begin(mCves), std::end(mCves), cveId.value(), [](const CveEntry& entry, std::uint64_t id) {
+            return entry.id < id;
+        });
+    if (it == std::end(mCves) || it->id != cveId.value()) {
+        return {};
+    }
+    return records(*it);
+}
+
+std::span<const TrackerIndex::CveEntry> TrackerIndex::cves(CveId first, CveId last) const {
+    const auto begin = std::lower_bound(
+        std::begin(mCves), std::end(mCves), first.value(), [](const CveEntry& entry, std::uint64_t id) {
+            return entry.id < id;
+        });
+    const auto end = std::upper_bound(
+        begin, std::end(mCves), last.value(), [](std::uint64_t id, const CveEntry& entry) {
+            return id < entry.id;
+        });
+    return { begin, end };
+}
+
+std::span<const TrackerIndex::PackageRecord> TrackerIndex::findPackage(std::string_view package) const {
+    const auto i = packageNumber(package);
+    return i ? packageRecords(*i) : std::span<const PackageRecord>();
+}
+
+std::optional<std::size_t> TrackerIndex::packageNumber(std::string_view package) const {
+    const auto it = std::lower_bound(std::begin(mPackages),
+                                     std::end(mPackages),
+                                     package,
+                                     [this](const PackageEntry& entry, std::string_view name) {
+                                         return string(entry.name) < name;
+                                     });
+    if (it == std::end(mPackages) || string(it->name) != package) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(it - std::begin(mPackages));
+}
+
+std::string_view TrackerIndex::string(std::uint32_t offset) const {
+    return readString(mStrings, offset);
+}
@@ -0,0 +1,260 @@
+#include "cveinfo/cve/TrackerParser.hpp"
+
+#include "cveinfo/cve/schema.hpp"
+
+#include <spdlog/fmt/fmt.h>
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace cveinfo;
+using debian::TrackerParser;
+
+namespace {
+
+constexpr auto NPOS = std::string_view::npos;
+
+std::size_t skipWhitespace(std::string_view document, std::size_t i) {
+    while (i < document.size() &&
+           (document[i] == ' ' || document[i] == '\n' || document[i] == '\r' || document[i] == '\t')) {
+        ++i;
+    }
+    return i;
+}
+
+/// Returns the position after the string starting at @p i, NPOS if it isn't terminated.
+std::size_t skipString(std::string_view document, std::size_t i) {
+    for (++i; i < document.size();) {
+        const auto* quote =
+            static_cast<const char*>(std::memchr(document.data() + i, '"', document.size() - i));
+        if (quote == nullptr) {
+            return NPOS;
+        }
+        const auto end = static_cast<std::size_t>(quote - document.data());
+        // The quote is escaped by an odd number of backslashes
+        std::size_t backslashes = 0;
+        while (document[end - backslashes - 1] == '\\') {
+            ++backslashes;
+        }
+        i = end + 1;
+        if (backslashes % 2 == 0) {
+            return i;
+        }
+    }
+    return NPOS;
+}
+
+/// Returns the position after the value starting at @p i, NPOS if its brackets aren't balanced.
+std::size_t skipValue(std::string_view document, std::size_t i) {
+    if (i >= document.size()) {
+        return NPOS;
+    }
+    if (document[i] == '"') {
+        return skipString(document, i);
+    }
+    if (document[i] != '{' && document[i] != '[') {
+        const auto end = document.find_first_of(",} \n\r\t", i);
+        return end == NPOS ? document.size() : end;
+    }
+    std::size_t depth = 0;
+    while (i < document.size()) {
+        switch (document[i]) {
+        case '"':
+            i = skipString(document, i);
+            if (i == NPOS) {
+                return NPOS;
+            }
+            continue;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (--depth == 0) {
+                return i + 1;
+            }
+            break;
+        default:
+            break;
+        }
+        ++i;
+    }
+    return NPOS;
+}
+
+} // namespace
+
+TrackerParser::TrackerParser(TrackerIndex::Builder& builder, std::optional<std::string> codename)
+    : mBuilder(builder)
+    , mCodename(std::move(codename)) {}
+
+void TrackerParser::parse(std::istream& input) {
+    nlohmann::json::sax_parse(input, this);
+}
+
+std::optional<std::vector<TrackerParser::Package>> TrackerParser::splitPackages(std::string_view document) {
+    std::vector<Package> packages;
+    auto i = skipWhitespace(document, 0);
+    if (i == document.size() || document[i] != '{') {
+        return std::nullopt;
+    }
+    i = skipWhitespace(document, i + 1);
+    if (i < document.size() && document[i] == '}') {
+        return skipWhitespace(document, i + 1) == document.size() ? std::optional(packages) : std::nullopt;
+    }
+    while (i < document.size() && document[i] == '"') {
+        const auto keyEnd = skipString(document, i);
+        if (keyEnd == NPOS) {
+            return std::nullopt;
+        }
+        const auto key = document.substr(i, keyEnd - i);
+        // Package names never need escaping in practice, the JSON parser handles the exceptions
+        std::string name;
+        if (key.find('\\') == std::string_view::npos) {
+            name = key.substr(1, key.size() - 2);
+        } else if (const auto decoded = nlohmann::json::parse(key, nullptr, false); decoded.is_string()) {
+            name = decoded.get<std::string>();
+        } else {
+            return std::nullopt;
+        }
+        i = skipWhitespace(document, keyEnd);
+        if (i == document.size() || document[i] != ':') {
+            return std::nullopt;
+        }
+        i = skipWhitespace(document, i + 1);
+        const auto valueEnd = skipValue(document, i);
+        if (valueEnd == NPOS) {
+            return std::nullopt;
+        }
+        packages.push_back(Package{ std::move(name), document.substr(i, valueEnd - i) });
+
+        i = skipWhitespace(document, valueEnd);
+        if (i < document.size() && document[i] == '}') {
+            i = skipWhitespace(document, i + 1);
+            return i == document.size() ? std::optional(std::move(packages)) : std::nullopt;
+        }
+        if (i == document.size() || document[i] != ',') {
+            return std::nullopt;
+        }
+        i = skipWhitespace(document, i + 1);
+    }
+    return std::nullopt;
+}
+
+void TrackerParser::parse(std::string_view document) {
+    nlohmann::json::sax_parse(document, this);
+}
+
+void TrackerParser::parsePackage(const Package& package) {
+    mKey = package.name;
+    mDepth = ROOT;
+    mArrays = 0;
+    try {
+        nlohmann::json::sax_parse(package.value, this);
+    } catch (const std::exception& e) {
+        // Positions are relative to the package
+        throw std::runtime_error(fmt::format("{} in package {}", e.what(), package.name));
+    }
+}
+
+void TrackerParser::beginValue() {
+    // Nothing inside of an array is of any interest
+    if (mArrays > 0) {
+        return;
+    }
+    switch (mDepth) {
+    case ROOT:
+        mPackage = mKey;
+        break;
+    case PACKAGE:
+        mCveId = CveId::parse(mKey);
+        mHasReleases = false;
+        mReleases.clear();
+        break;
+    case CVE:
+        if (mKey == schema::RELEASES) {
+            mHasReleases = true;
+            mInReleases = true;
+        }
+        break;
+    case RELEASES:
+        if (mInReleases) {
+            mSkipRelease = mCodename && *mCodename != mKey;
+            if (!mSkipRelease) {
+                mReleases.push_back(PendingRelease{ mKey, std::nullopt, std::nullopt });
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void TrackerParser::endValue() {
+    if (mArrays > 0) {
+        return;
+    }
+    if (mDepth == PACKAGE && mCveId) {
+        mBuilder.addRecord(mPackage, *mCveId, mHasReleases);
+        for (const auto& release : mReleases) {
+            mBuilder.addRelease(release.codename, release.status, release.fixedVersion);
+        }
+    } else if (mDepth == CVE) {
+        mInReleases = false;
+    }
+}
+
+bool TrackerParser::value() {
+    beginValue();
+    endValue();
+    return true;
+}
+
+bool TrackerParser::string(string_t& val) {
+    beginValue();
+    if (mArrays == 0 && mDepth == RELEASE && mInReleases && !mSkipRelease) {
+        if (mKey == schema::STATUS) {
+            mReleases.back().status = val;
+        } else if (mKey == schema::FIXED_VERSION) {
+            mReleases.back().fixedVersion = val;
+        }
+    }
+    endValue();
+    return true;
+}
+
+bool TrackerParser::start_object(std::size_t) {
+    beginValue();
+    ++mDepth;
+    return true;
+}
+
+bool TrackerParser::end_object() {
+    --mDepth;
+    endValue();
+    return true;
+}
+
+bool TrackerParser::start_array(std::size_t) {
+    beginValue();
+    ++mDepth;
+    ++mArrays;
+    return true;
+}
+
+bool TrackerParser::end_array() {
+    --mDepth;
+    --mArrays;
+    endValue();
+    return true;
+}
+
+bool TrackerParser::key(string_t& val) {
+    mKey = val;
+    return true;
+}
+
+bool TrackerParser::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) {
+    throw std::runtime_error(ex.what());
+}
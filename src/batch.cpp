@@ -0,0 +1,123 @@
+#include "cveinfo/batch.hpp"
+
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/NistFetcher.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/nist.hpp"
+#include "cveinfo/cve/serialization.hpp"
+#include "cveinfo/profile.hpp"
+#include "cveinfo/utils/stringUtils.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <cctype>
+#include <vector>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+// Number of lines resolved concurrently; bounds the memory used by the in-flight NVD lookups
+constexpr std::size_t CHUNK_SIZE = 256;
+
+struct PendingQuery {
+    batch::Query query;
+    // Not set for malformed CVE IDs, which aren't looked up
+    std::optional<std::future<std::optional<nist::CveDescription>>> description;
+};
+
+} // namespace
+
+std::optional<batch::Query> batch::parseQuery(const std::string& line) {
+    const auto tokens = utils::tokenize(
+        line,
+        [](const char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; },
+        utils::TokenizeMode::EXCLUDE_EMPTY_TOKENS);
+    if (tokens.empty() || tokens.front().front() == '#') {
+        return std::nullopt;
+    }
+    return Query{ tokens[0], tokens.size() > 1 ? std::optional(tokens[1]) : std::nullopt };
+}
+
+json batch::resolve(const debian::DebianSecurityTracker& tracker,
+                    const Query& query,
+                    const std::optional<nist::CveDescription>& description,
+                    const Options& options) {
+    profile::add(profile::Counter::QUERIES);
+    const auto cveId = CveId::parse(query.cveId);
+    if (!cveId) {
+        spdlog::error("Malformed CVE ID: {}", query.cveId);
+        return json{ { "cveId", query.cveId }, { "error", "malformed CVE ID" } };
+    }
+    json result = { { "cveId", cveId->str() } };
+
+    if (description) {
+        json nvd = *description;
+        nvd.erase("cveId");
+        if (options.noCvss) {
+            nvd.erase("vectorString");
+        }
+        result["nvd"] = std::move(nvd);
+    } else {
+        result["nvd"] = nullptr;
+    }
+
+    auto packages = tracker.getTrackerInfo(*cveId);
+    if (query.packageName && packages.size() > 1) {
+        const auto it = debian::findPackage(packages, *query.packageName);
+        if (it != std::end(packages)) {
+            packages = { *it };
+        } else {
+            spdlog::error("Given CVE ID {} not found in the given package", *cveId);
+            packages.clear();
+        }
+    }
+    result["debian"] = packages;
+    return result;
+}
+
+int batch::run(std::istream& input, std::ostream& output, const Options& options) {
+    const debian::DebianSecurityTracker tracker(options.codename, options.trackerFreshness);
+    nist::Store store(nist::Store::defaultPath(), options.cacheSize);
+    nist::Fetcher fetcher(options.apiKey, options.jobs);
+
+    std::vector<PendingQuery> chunk;
+    chunk.reserve(CHUNK_SIZE);
+    std::size_t resolved = 0;
+    const auto flush = [&] {
+        for (auto& pending : chunk) {
+            const auto description = pending.description ? pending.description->get() : std::nullopt;
+            output << resolve(tracker, pending.query, description, options).dump() << '\n';
+        }
+        resolved += chunk.size();
+        chunk.clear();
+    };
+
+    std::string line;
+    while (std::getline(input, line)) {
+        auto query = parseQuery(line);
+        if (!query) {
+            continue;
+        }
+        PendingQuery pending{ std::move(*query), std::nullopt };
+        if (const auto cveId = CveId::parse(pending.query.cveId)) {
+            pending.description = nist::getCveDescriptionAsync(*cveId, fetcher, store, options.nvdFreshness);
+        }
+        chunk.push_back(std::move(pending));
+        if (chunk.size() == CHUNK_SIZE) {
+            flush();
+        }
+    }
+    flush();
+    output.flush();
+    spdlog::debug("Resolved {} CVEs", resolved);
+    fetcher.logStats();
+
+    if (!output) {
+        spdlog::error("Failed to write batch results");
+        return 1;
+    }
+    return 0;
+}
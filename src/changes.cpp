@@ -0,0 +1,307 @@
+#include "cveinfo/changes.hpp"
+
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/refresh.hpp"
+#include "cveinfo/utils/utils.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <compare>
+#include <fstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace cveinfo;
+using changes::Change;
+using debian::TrackerIndex;
+using nlohmann::json;
+
+namespace {
+
+// Readers only need the changes since they last polled, a rotated feed is kept just for the slow ones
+constexpr std::uint64_t MAX_FEED_SIZE = 16 * 1024 * 1024;
+
+json toJson(std::optional<std::string_view> value) {
+    return value ? json(*value) : json();
+}
+
+std::string_view typeName(Change::Type type) {
+    switch (type) {
+    case Change::Type::NEW_CVE:
+        return "new";
+    case Change::Type::REMOVED_CVE:
+        return "removed";
+    case Change::Type::STATUS:
+        return "status";
+    case Change::Type::FIXED_VERSION:
+        return "fixedVersion";
+    case Change::Type::SCORE:
+        return "score";
+    }
+    return "unknown";
+}
+
+/// Adds a change of @p type of each record of package number @p package of @p index
+void addAll(const TrackerIndex& index, std::size_t package, Change::Type type, std::vector<Change>& changes) {
+    for (const auto& packageRecord : index.packageRecords(package)) {
+        changes.push_back(Change{ type,
+                                  index.cveId(packageRecord),
+                                  std::string(index.packageName(package)),
+                                  std::nullopt,
+                                  nullptr,
+                                  nullptr });
+    }
+}
+
+/// Compares the releases of the record of @p cveId in both indexes, both are ordered by codename
+void diffReleases(const TrackerIndex& before,
+                  const TrackerIndex::Record& beforeRecord,
+                  const TrackerIndex& after,
+                  const TrackerIndex::Record& afterRecord,
+                  std::string_view package,
+                  CveId cveId,
+                  std::vector<Change>& changes) {
+    const auto beforeReleases = before.releases(beforeRecord);
+    auto previous = std::begin(beforeReleases);
+    for (const auto& release : after.releases(afterRecord)) {
+        const auto codename = after.string(release.codename);
+        while (previous != std::end(beforeReleases) && before.string(previous->codename) < codename) {
+            ++previous;
+        }
+        const bool existed =
+            previous != std::end(beforeReleases) && before.string(previous->codename) == codename;
+        const auto oldStatus = existed ? before.optionalString(previous->status) : std::nullopt;
+        const auto oldFixedVersion = existed ? before.optionalString(previous->fixedVersion) : std::nullopt;
+        const auto status = after.optionalString(release.status);
+        const auto fixedVersion = after.optionalString(release.fixedVersion);
+
+        const auto change = [&](Change::Type type,
+                                std::optional<std::string_view> from,
+                                std::string_view to) {
+            changes.push_back(Change{ type,
+                                      cveId,
+                                      std::string(package),
+                                      std::string(codename),
+                                      toJson(from),
+                                      json(to) });
+        };
+        if (status && status != oldStatus) {
+            change(Change::Type::STATUS, oldStatus, *status);
+        }
+        if (fixedVersion && fixedVersion != oldFixedVersion) {
+            change(Change::Type::FIXED_VERSION, oldFixedVersion, *fixedVersion);
+        }
+    }
+}
+
+/// Compares the records of a package found in both indexes, both are ordered by CVE ID
+void diffPackage(const TrackerIndex& before,
+                 std::size_t beforePackage,
+                 const TrackerIndex& after,
+                 std::size_t afterPackage,
+                 std::vector<Change>& changes) {
+    const auto package = after.packageName(afterPackage);
+    const auto beforeRecords = before.packageRecords(beforePackage);
+    const auto afterRecords = after.packageRecords(afterPackage);
+    auto b = std::begin(beforeRecords);
+    auto a = std::begin(afterRecords);
+    while (b != std::end(beforeRecords) || a != std::end(afterRecords)) {
+        const auto order = b == std::end(beforeRecords)  ? std::strong_ordering::greater
+                           : a == std::end(afterRecords) ? std::strong_ordering::less
+                                                         : before.cveId(*b) <=> after.cveId(*a);
+        if (order < 0) {
+            changes.push_back(Change{ Change::Type::REMOVED_CVE,
+                                      before.cveId(*b),
+                                      std::string(package),
+                                      std::nullopt,
+                                      nullptr,
+                                      nullptr });
+            ++b;
+        } else if (order > 0) {
+            changes.push_back(Change{ Change::Type::NEW_CVE,
+                                      after.cveId(*a),
+                                      std::string(package),
+                                      std::nullopt,
+                                      nullptr,
+                                      nullptr });
+            ++a;
+        } else {
+            diffReleases(
+                before, before.record(*b), after, after.record(*a), package, after.cveId(*a), changes);
+            ++b;
+            ++a;
+        }
+    }
+}
+
+} // namespace
+
+void changes::to_json(json& j, const Change& change) {
+    j = json::object();
+    j["type"] = typeName(change.type);
+    j["cveId"] = change.cveId.str();
+    if (change.package) {
+        j["package"] = *change.package;
+    }
+    if (change.codename) {
+        j["codename"] = *change.codename;
+    }
+    if (change.type != Change::Type::NEW_CVE && change.type != Change::Type::REMOVED_CVE) {
+        j["from"] = change.from;
+        j["to"] = change.to;
+    }
+}
+
+std::vector<Change> changes::diff(const TrackerIndex& before, const TrackerIndex& after) {
+    std::vector<Change> changes;
+    std::size_t b = 0;
+    std::size_t a = 0;
+    while (b < before.packageCount() || a < after.packageCount()) {
+        const auto order = b == before.packageCount() ? 1
+                           : a == after.packageCount()
+                               ? -1
+                               : before.packageName(b).compare(after.packageName(a));
+        if (order < 0) {
+            addAll(before, b++, Change::Type::REMOVED_CVE, changes);
+        } else if (order > 0) {
+            addAll(after, a++, Change::Type::NEW_CVE, changes);
+        } else {
+            const auto hash = after.sourceHash(a);
+            if (hash == 0 || hash != before.sourceHash(b)) {
+                diffPackage(before, b, after, a, changes);
+            }
+            ++b;
+            ++a;
+        }
+    }
+    return changes;
+}
+
+std::optional<Change> changes::diff(const nist::CveDescription& before, const nist::CveDescription& after) {
+    // CVSS scores have a single decimal place, the float rounding error isn't a change
+    const auto round = [](std::optional<float> score) {
+        return score ? json(std::round(static_cast<double>(*score) * 10) / 10) : json();
+    };
+    auto from = round(before.score);
+    auto to = round(after.score);
+    if (from == to) {
+        return std::nullopt;
+    }
+    return Change{
+        Change::Type::SCORE, after.cveId, std::nullopt, std::nullopt, std::move(from), std::move(to)
+    };
+}
+
+std::vector<Change> changes::diff(nist::Store& store, const std::vector<nist::CveDescription>& descriptions) {
+    std::vector<Change> changes;
+    for (const auto& description : descriptions) {
+        if (const auto previous = store.get(description.cveId)) {
+            if (auto change = diff(previous->description, description)) {
+                changes.push_back(std::move(*change));
+            }
+        }
+    }
+    return changes;
+}
+
+std::filesystem::path changes::feedPath() {
+    return utils::createCveInfoDir() / "changes.jsonl";
+}
+
+void changes::publish(const std::vector<Change>& changes) {
+    if (changes.empty()) {
+        return;
+    }
+    const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    std::string lines;
+    for (const auto& change : changes) {
+        json line = change;
+        line["time"] = now;
+        lines += line.dump();
+        lines += '\n';
+    }
+
+    const auto path = feedPath();
+    try {
+        auto lockPath = path;
+        lockPath += ".lock";
+        const auto lease = refresh::Lease::acquire(lockPath);
+
+        std::error_code ec;
+        if (const auto size = std::filesystem::file_size(path, ec); !ec && size > MAX_FEED_SIZE) {
+            auto rotated = path;
+            rotated += ".1";
+            std::filesystem::rename(path, rotated);
+        }
+        const int fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error{ std::error_code{ errno, std::system_category() }, path };
+        }
+        for (std::size_t written = 0; written < lines.size();) {
+            const auto n = ::write(fd, lines.data() + written, lines.size() - written);
+            if (n < 0 && errno != EINTR) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error{ std::error_code{ error, std::system_category() }, path };
+            }
+            written += n > 0 ? static_cast<std::size_t>(n) : 0;
+        }
+        ::close(fd);
+        spdlog::debug("Published {} changes", changes.size());
+    } catch (const std::exception& e) {
+        spdlog::warn("Failed to publish {} changes: {}", changes.size(), e.what());
+    }
+}
+
+changes::Follower::Follower()
+    : mPath(feedPath()) {
+    struct stat buf;
+    if (stat(mPath.c_str(), &buf) == 0) {
+        mInode = buf.st_ino;
+        mOffset = static_cast<std::uint64_t>(buf.st_size);
+    }
+}
+
+std::vector<json> changes::Follower::poll() {
+    std::vector<json> changes;
+    struct stat buf;
+    if (stat(mPath.c_str(), &buf) != 0) {
+        return changes;
+    }
+    if (buf.st_ino != mInode) {
+        // The feed was rotated, the rest of the previous one comes first
+        auto rotated = mPath;
+        rotated += ".1";
+        struct stat rotatedBuf;
+        if (mInode != 0 && stat(rotated.c_str(), &rotatedBuf) == 0 && rotatedBuf.st_ino == mInode) {
+            read(rotated, changes);
+        }
+        mInode = buf.st_ino;
+        mOffset = 0;
+    }
+    read(mPath, changes);
+    return changes;
+}
+
+void changes::Follower::read(const std::filesystem::path& path, std::vector<json>& changes) {
+    std::ifstream input(path, std::ios::binary);
+    input.seekg(static_cast<std::streamoff>(mOffset));
+    std::string line;
+    // A line without its newline is still being written, it's read by the next poll
+    while (std::getline(input, line) && !input.eof()) {
+        mOffset += line.size() + 1;
+        try {
+            changes.push_back(json::parse(line));
+        } catch (const std::exception& e) {
+            spdlog::warn("Skipping corrupted change: {}", e.what());
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#include "cveinfo/cpe.hpp"
+
+#include "cveinfo/changes.hpp"
+#include "cveinfo/cve/NistFetcher.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/nist.hpp"
+#include "cveinfo/cve/serialization.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <cctype>
+#include <future>
+#include <mutex>
+#include <string_view>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+constexpr std::string_view CPE_23_PREFIX = "cpe:2.3:";
+
+/// Percent-encodes @p value for a URL query, CPE names may contain quoted punctuation (e.g. "\&")
+std::string encodeQueryValue(std::string_view value) {
+    std::string encoded;
+    encoded.reserve(value.size());
+    for (const char c : value) {
+        const auto byte = static_cast<unsigned char>(c);
+        if (std::isalnum(byte) || std::string_view("-._~:*").find(c) != std::string_view::npos) {
+            encoded += c;
+        } else {
+            encoded += fmt::format("%{:02X}", byte);
+        }
+    }
+    return encoded;
+}
+
+std::string nvdQuery(const cpe::Query& query) {
+    return (query.virtualMatch ? "virtualMatchString=" : "cpeName=") + encodeQueryValue(query.name);
+}
+
+} // namespace
+
+int cpe::run(const std::vector<Query>& queries, std::ostream& output, const Options& options) {
+    for (const auto& query : queries) {
+        if (!query.name.starts_with(CPE_23_PREFIX)) {
+            spdlog::error("Invalid CPE name {}: expected a CPE 2.3 name ({}...)", query.name, CPE_23_PREFIX);
+            return 1;
+        }
+    }
+
+    nist::Store store(nist::Store::defaultPath(), options.cacheSize);
+    nist::Fetcher fetcher(options.apiKey, options.jobs);
+
+    std::mutex outputMutex;
+    std::atomic<std::size_t> found = 0;
+    const auto writePage = [&](const Query& query, const json& page) {
+        const auto descriptions = nist::parsePage(page);
+        const auto changed = changes::diff(store, descriptions);
+        store.put(descriptions, std::chrono::system_clock::now());
+        changes::publish(changed);
+
+        std::string lines;
+        for (const auto& description : descriptions) {
+            json nvd = description;
+            nvd.erase("cveId");
+            if (options.noCvss) {
+                nvd.erase("vectorString");
+            }
+            lines += json{
+                { "cpe", query.name }, { "cveId", description.cveId.str() }, { "nvd", std::move(nvd) }
+            }.dump();
+            lines += '\n';
+        }
+        found += descriptions.size();
+
+        const std::lock_guard<std::mutex> lock(outputMutex);
+        output << lines;
+        output.flush();
+        return static_cast<bool>(output);
+    };
+
+    // Each query pages concurrently on its own, running them side by side overlaps their first pages
+    std::vector<std::future<bool>> runs;
+    runs.reserve(queries.size());
+    for (const auto& query : queries) {
+        runs.push_back(std::async(std::launch::async, [&fetcher, &writePage, &query] {
+            return nist::fetchPages(fetcher, nvdQuery(query), query.name, [&](const json& page) {
+                return writePage(query, page);
+            });
+        }));
+    }
+    bool complete = true;
+    for (auto& run : runs) {
+        complete = run.get() && complete;
+    }
+    spdlog::debug("Found {} CVEs of {} CPE queries", found.load(), queries.size());
+    fetcher.logStats();
+
+    if (!output) {
+        spdlog::error("Failed to write CPE results");
+        return 1;
+    }
+    if (!complete) {
+        spdlog::error("CPE results incomplete, some NVD pages couldn't be retrieved");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "cveinfo/cveinfo.h"
+
+#include "cveinfo/Context.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+struct cveinfo_context {
+    explicit cveinfo_context(Options options)
+        : context(std::move(options)) {}
+
+    Context context;
+};
+
+namespace {
+
+std::chrono::seconds durationOf(const json& value, const char* name) {
+    const auto duration = utils::parseDuration(value.get<std::string>());
+    if (!duration) {
+        throw std::invalid_argument(fmt::format("invalid duration for {}: {}", name, value.dump()));
+    }
+    return *duration;
+}
+
+Options parseOptions(const char* text) {
+    Options options;
+    if (!text) {
+        return options;
+    }
+    const auto parsed = json::parse(text);
+    if (!parsed.is_object()) {
+        throw std::invalid_argument("options have to be a JSON object");
+    }
+    for (const auto& [name, value] : parsed.items()) {
+        if (name == "codename") {
+            options.codename = value.get<std::string>();
+        } else if (name == "apiKey") {
+            options.apiKey = value.get<std::string>();
+        } else if (name == "jobs") {
+            options.jobs = std::max<std::size_t>(value.get<std::size_t>(), 1);
+        } else if (name == "cacheSize") {
+            options.cacheSize = std::max<std::uint64_t>(value.get<std::uint64_t>(), 1) * 1024 * 1024;
+        } else if (name == "noCvss") {
+            options.noCvss = value.get<bool>();
+        } else if (name == "trackerMaxAge") {
+            options.trackerFreshness.maxAge = durationOf(value, "trackerMaxAge");
+        } else if (name == "trackerMaxStale") {
+            options.trackerFreshness.maxStale = durationOf(value, "trackerMaxStale");
+        } else if (name == "nvdMaxAge") {
+            options.nvdFreshness.maxAge = durationOf(value, "nvdMaxAge");
+        } else if (name == "nvdMaxStale") {
+            options.nvdFreshness.maxStale = durationOf(value, "nvdMaxStale");
+        } else {
+            throw std::invalid_argument("unknown option " + name);
+        }
+    }
+    return options;
+}
+
+/// Invalid UTF-8 in results (from NVD descriptions or package names) is replaced rather than thrown on
+std::string dump(const json& result) {
+    return result.dump(-1, ' ', false, json::error_handler_t::replace);
+}
+
+batch::Query makeQuery(const char* cveId, const char* packageName) {
+    return batch::Query{ cveId, packageName ? std::optional<std::string>(packageName) : std::nullopt };
+}
+
+} // namespace
+
+cveinfo_context* cveinfo_open(const char* options) {
+    try {
+        return new cveinfo_context(parseOptions(options));
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to create cveinfo context: {}", e.what());
+        return nullptr;
+    }
+}
+
+void cveinfo_close(cveinfo_context* context) {
+    delete context;
+}
+
+int cveinfo_query(cveinfo_context* context,
+                  const char* cve_id,
+                  const char* package_name,
+                  cveinfo_callback done,
+                  void* user_data) {
+    if (!context || !cve_id || !done) {
+        return -1;
+    }
+    try {
+        context->context.query(
+            makeQuery(cve_id, package_name), [done, user_data, cveId = std::string(cve_id)](json result) {
+                // Called from an NVD worker, nothing may escape it
+                std::string text;
+                try {
+                    text = dump(result);
+                } catch (const std::exception& e) {
+                    spdlog::error("Failed to serialize the result of {}: {}", cveId, e.what());
+                    text = dump(json{ { "cveId", cveId }, { "error", e.what() } });
+                }
+                done(text.c_str(), user_data);
+            });
+        return 0;
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to query {}: {}", cve_id, e.what());
+        return -1;
+    }
+}
+
+char* cveinfo_query_sync(cveinfo_context* context, const char* cve_id, const char* package_name) {
+    if (!context || !cve_id) {
+        return nullptr;
+    }
+    try {
+        return strdup(dump(context->context.query(makeQuery(cve_id, package_name)).get()).c_str());
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to query {}: {}", cve_id, e.what());
+        return nullptr;
+    }
+}
+
+void cveinfo_free(char* result) {
+    free(result);
+}
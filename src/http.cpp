@@ -0,0 +1,159 @@
+#include "cveinfo/http.hpp"
+
+#include "cveinfo/endpoints.hpp"
+#include "cveinfo/profile.hpp"
+
+#include <curl/curl.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace cveinfo;
+
+namespace {
+
+// More than the workers of a Fetcher, so its sessions all stay pooled between requests
+constexpr std::size_t MAX_IDLE_SESSIONS_PER_HOST = 16;
+
+std::atomic<std::size_t> gOpened = 0;
+std::atomic<std::size_t> gReused = 0;
+
+/// libcurl share of the TLS sessions and DNS lookups of all sessions.
+///
+/// Connections themselves can't be shared by sessions used on different threads, each pooled session keeps
+/// its own open instead.
+class Share {
+public:
+    Share()
+        : mShare(curl_share_init()) {
+        curl_share_setopt(mShare, CURLSHOPT_LOCKFUNC, &Share::lock);
+        curl_share_setopt(mShare, CURLSHOPT_UNLOCKFUNC, &Share::unlock);
+        curl_share_setopt(mShare, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    }
+
+    ~Share() { curl_share_cleanup(mShare); }
+
+    Share(const Share&) = delete;
+    Share& operator=(const Share&) = delete;
+
+    CURLSH* get() const { return mShare; }
+
+private:
+    static void lock(CURL*, curl_lock_data data, curl_lock_access, void* share) {
+        static_cast<Share*>(share)->mLocks[static_cast<std::size_t>(data)].lock();
+    }
+
+    static void unlock(CURL*, curl_lock_data data, void* share) {
+        static_cast<Share*>(share)->mLocks[static_cast<std::size_t>(data)].unlock();
+    }
+
+    CURLSH* mShare;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> mLocks;
+};
+
+class Pool {
+public:
+    /// Returns an idle session of @p host, or a new one if they're all in use.
+    std::unique_ptr<cpr::Session> take(const std::string& host) {
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+            if (auto& idle = mIdle[host]; !idle.empty()) {
+                auto session = std::move(idle.back());
+                idle.pop_back();
+                return session;
+            }
+        }
+        return makeSession();
+    }
+
+    /// Returns @p session to the pool of @p host, with its connection still open.
+    void put(const std::string& host, std::unique_ptr<cpr::Session> session) {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        if (auto& idle = mIdle[host]; idle.size() < MAX_IDLE_SESSIONS_PER_HOST) {
+            idle.push_back(std::move(session));
+        }
+    }
+
+    std::unique_ptr<cpr::Session> makeSession() const {
+        auto session = std::make_unique<cpr::Session>();
+        session->SetVerifySsl(cpr::VerifySsl{ true });
+        if (auto caBundle = endpoints::caBundle()) {
+            session->SetSslOptions(cpr::Ssl(cpr::ssl::CaInfo{ std::move(*caBundle) }));
+        }
+        // Falls back to HTTP/1.1 if the server or libcurl doesn't support HTTP/2
+        session->SetHttpVersion(cpr::HttpVersion{ cpr::HttpVersionCode::VERSION_2_0_TLS });
+        session->SetAcceptEncoding({ cpr::AcceptEncodingMethods::gzip, cpr::AcceptEncodingMethods::deflate });
+        curl_easy_setopt(session->GetCurlHolder()->handle, CURLOPT_SHARE, mShare.get());
+        return session;
+    }
+
+private:
+    // Outlives the sessions using it
+    Share mShare;
+    std::mutex mMutex;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<cpr::Session>>> mIdle;
+};
+
+Pool& pool() {
+    static Pool instance;
+    return instance;
+}
+
+/// Returns the scheme and authority of @p url, the part connections are reused for.
+std::string hostOf(const std::string& url) {
+    const auto scheme = url.find("://");
+    const auto start = scheme == std::string::npos ? 0 : scheme + 3;
+    return url.substr(0, url.find_first_of("/?#", start));
+}
+
+void countConnections(cpr::Session& session, const cpr::Response& response) {
+    if (response.error) {
+        return;
+    }
+    long connects = 0;
+    curl_easy_getinfo(session.GetCurlHolder()->handle, CURLINFO_NUM_CONNECTS, &connects);
+    if (connects > 0) {
+        gOpened += static_cast<std::size_t>(connects);
+        profile::add(profile::Counter::HTTP_CONNECTIONS_OPENED, static_cast<std::uint64_t>(connects));
+    } else {
+        ++gReused;
+        profile::add(profile::Counter::HTTP_CONNECTIONS_REUSED);
+    }
+}
+
+} // namespace
+
+cpr::Response http::get(const std::string& url, const cpr::Header& header) {
+    const auto host = hostOf(url);
+    auto session = pool().take(host);
+    session->SetUrl(cpr::Url{ url });
+    session->SetHeader(header);
+    auto response = session->Get();
+    countConnections(*session, response);
+    pool().put(host, std::move(session));
+    return response;
+}
+
+cpr::Response http::download(const std::string& url,
+                             const cpr::Header& header,
+                             const cpr::WriteCallback& onData) {
+    // The session would keep calling onData for its next requests, it's not worth pooling for a single
+    // download anyway
+    auto session = pool().makeSession();
+    session->SetUrl(cpr::Url{ url });
+    session->SetHeader(header);
+    auto response = session->Download(onData);
+    countConnections(*session, response);
+    return response;
+}
+
+http::Stats http::stats() {
+    return Stats{ gOpened, gReused };
+}
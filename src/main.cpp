@@ -1,5 +1,20 @@
+#include "cveinfo/CveId.hpp"
+#include "cveinfo/batch.hpp"
+#include "cveinfo/cpe.hpp"
 #include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/NistFetcher.hpp"
+#include "cveinfo/cve/NistMirror.hpp"
+#include "cveinfo/cve/NistStore.hpp"
 #include "cveinfo/cve/nist.hpp"
+#include "cveinfo/endpoints.hpp"
+#include "cveinfo/options.hpp"
+#include "cveinfo/package.hpp"
+#include "cveinfo/profile.hpp"
+#include "cveinfo/sbom.hpp"
+#include "cveinfo/scan.hpp"
+#include "cveinfo/server.hpp"
+#include "cveinfo/snapshot.hpp"
+#include "cveinfo/watch.hpp"
 
 #include <spdlog/fmt/bundled/color.h>
 #include <spdlog/fmt/chrono.h>
@@ -7,10 +22,16 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
 #include <optional>
 #include <stdio.h>
 #include <string_view>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 namespace {
 
@@ -63,7 +84,7 @@ void print(const cveinfo::nist::CveDescription& description, bool no_cvss) {
 }
 
 void print(const cveinfo::debian::DebianSecurityTracker& tracker,
-           const std::string& cveId,
+           cveinfo::CveId cveId,
            const std::optional<std::string>& name) {
     const auto printPackage = [](const cveinfo::debian::TrackerInfo& info) {
         fmt::println("  Package: {}", info.packageName);
@@ -80,40 +101,7 @@ void print(const cveinfo::debian::DebianSecurityTracker& tracker,
     try {
         const auto packages = tracker.getTrackerInfo(cveId);
         if (name && packages.size() > 1) {
-            // Try finding exact match
-            auto it =
-                std::find_if(std::begin(packages), std::end(packages), [name = *name](const auto& package) {
-                    return package.packageName == name;
-                });
-
-            // Try finding given package name in debian's package name
-            if (it == std::end(packages)) {
-                it = std::find_if(
-                    std::begin(packages), std::end(packages), [name = *name](const auto& package) {
-                        return package.packageName.find(name) != std::string::npos;
-                    });
-                if (it != std::end(packages)) {
-                    spdlog::warn("Given CVE ID {} matching package name only partially: {} ~= {}",
-                                 cveId,
-                                 *name,
-                                 it->packageName);
-                }
-            }
-
-            // Try finding debian's package name in given package's name
-            if (it == std::end(packages)) {
-                it = std::find_if(
-                    std::begin(packages), std::end(packages), [name = *name](const auto& package) {
-                        return name.find(package.packageName) != std::string::npos;
-                    });
-                if (it != std::end(packages)) {
-                    spdlog::warn("Given CVE ID {} matching package name only partially: {} ~= {}",
-                                 cveId,
-                                 it->packageName,
-                                 *name);
-                }
-            }
-
+            const auto it = cveinfo::debian::findPackage(packages, *name);
             if (it != std::end(packages)) {
                 printPackage(*it);
             } else {
@@ -135,12 +123,64 @@ static void printUsage(const char* progname) {
     using namespace fmt::literals;
     fmt::print(stderr,
                R"usg({b}Usage{r}: {b}{progname}{r} [OPTIONS] <CVE ID> [package-name]
+       {b}{progname}{r} [OPTIONS] {b}--batch{r} <file>
+       {b}{progname}{r} [OPTIONS] {b}--package{r} <package-name>
+       {b}{progname}{r} [OPTIONS] {b}--cpe{r} <cpe-name>... {b}--cpe-match{r} <match-string>...
+       {b}{progname}{r} [OPTIONS] {b}--scan{r} <dpkg-status-file>
+       {b}{progname}{r} [OPTIONS] {b}--sbom{r} <sbom-file>
+       {b}{progname}{r} [OPTIONS] {b}--serve{r} <socket>
+       {b}{progname}{r} [OPTIONS] {b}--sync{r}
+       {b}{progname}{r} [OPTIONS] {b}--watch{r} <watchlist>
+       {b}{progname}{r} [OPTIONS] {b}--export{r} <file> | {b}--import{r} <file>
 
 {b}OPTIONS{r}:
   {b}-h{r}, {b}--help{r}                  Print this help message and exit
   {b}-v{r}, {b}--no-cvss{r}               Don't print CVSS vector
   {b}-c{r}, {b}--codename{r} {b}<codename>{r}   Use specific debian codename
-  {b}-k{r}, {b}--api-key{r} {b}<API KEY>{r}     NIST NVD API-key
+  {b}-k{r}, {b}--api-key{r} {b}<API KEY>{r}     NIST NVD API-key (default: $CVEINFO_NVD_API_KEY)
+  {b}-V{r}, {b}--verbose{r}               Print debug messages (e.g. peak memory usage)
+  {b}-b{r}, {b}--batch{r} {b}<file>{r}          Resolve "<CVE ID> [package-name]" lines from file
+                              ('-' for stdin) and print the results as JSON lines
+  {b}-p{r}, {b}--package{r} {b}<name>{r}        List the CVEs affecting a debian package as JSON lines, with
+                              severity and score from the local NVD cache
+  {b}--status{r} {b}<status>{r}           Only list releases with given tracker status (e.g. open)
+  {b}--cpe{r} {b}<name>{r}                List the NVD CVEs of a CPE 2.3 name as JSON lines, and cache them
+                              (repeatable)
+  {b}--cpe-match{r} {b}<string>{r}        Same for all the CPE names a match string covers, e.g. all the
+                              versions of cpe:2.3:a:openssl:openssl (repeatable)
+  {b}--scan{r} {b}<file>{r}               Report the CVEs fixed in newer versions of the packages installed
+                              according to a dpkg status file (e.g. /var/lib/dpkg/status)
+  {b}--sbom{r} {b}<file>{r}               Same for the debian packages of a CycloneDX or SPDX JSON SBOM
+  {b}--serve{r} {b}<socket>{r}            Answer "<CVE ID> [package-name]" lines sent to a Unix domain socket
+                              with JSON lines, keeping the databases loaded
+  {b}-s{r}, {b}--sync{r}                  Synchronize the local NVD mirror, lookups are then answered from it
+  {b}--watch{r} {b}<file>{r}              Keep the databases fresh and print the tracker and NVD score changes
+                              of the debian packages listed in file as JSON lines
+  {b}--watch-interval{r} {b}<time>{r}     Time between the checks of the watch mode (default: 5m)
+  {b}--export{r} {b}<file>{r}             Bundle the debian tracker database, its indexes and the NVD cache
+                              into a compressed snapshot
+  {b}--import{r} {b}<file>{r}             Replace the local databases with the ones of a snapshot
+  {b}-j{r}, {b}--jobs{r} {b}<N>{r}              Number of concurrent NVD requests in bulk modes (default: 8)
+  {b}--cache-size{r} {b}<MiB>{r}          Size limit of the NVD cache (default: 256)
+  {b}--tracker-max-age{r} {b}<time>{r}    Age after which the debian tracker is refreshed in the background
+                              (e.g. 90s, 30m, 2h, 7d; default: 1h)
+  {b}--tracker-max-stale{r} {b}<time>{r}  Age after which lookups wait for the debian tracker refresh
+                              (default: 1d)
+  {b}--nvd-max-age{r} {b}<time>{r}        Age after which NVD records are refreshed in the background
+                              (default: 1h)
+  {b}--nvd-max-stale{r} {b}<time>{r}      Age after which lookups wait for the NVD record refresh
+                              (default: 7d)
+  {b}--nvd-url{r} {b}<url>{r}            NVD CVE API endpoint, e.g. a local mock server
+                              (default: $CVEINFO_NVD_URL or the NIST service)
+  {b}--tracker-url{r} {b}<url>{r}        Debian security tracker JSON endpoint
+                              (default: $CVEINFO_TRACKER_URL or the debian service)
+  {b}--nvd-rate-limit{r} {b}<N>{r}       NVD requests allowed per 30 seconds (default: $CVEINFO_NVD_RATE_LIMIT
+                              or the published NVD limits)
+  {b}--ca-bundle{r} {b}<file>{r}          CA certificates the services are verified with
+                              (default: $CVEINFO_CA_BUNDLE or the system ones)
+  {b}--profile{r}                   Print the time spent per phase and the request and cache counters
+  {b}--trace{r} {b}<file>{r}              Write the phases as Chrome trace events (chrome://tracing, Perfetto)
+  {b}--metrics{r} {b}<file>{r}            Write the counters and phase timings in the Prometheus text format
 )usg",
                "progname"_a = progname,
                "b"_a = "[1m",
@@ -156,10 +196,33 @@ int main(const int argc, const char** argv) {
     spdlog::set_default_logger(logger);
 
     using namespace std::string_literals;
-    bool no_cvss = false;
-    std::optional<std::string> codename;
-    std::optional<std::string> apiKey;
+    cveinfo::Options options;
+    std::optional<std::string> batchFile;
+    std::optional<std::string> packageQuery;
+    std::vector<cveinfo::cpe::Query> cpeQueries;
+    std::optional<std::string> statusFile;
+    std::optional<std::string> sbomFile;
+    std::optional<std::string> socketPath;
+    std::optional<std::string> exportFile;
+    std::optional<std::string> importFile;
+    std::optional<std::string> watchFile;
+    std::chrono::seconds watchInterval = std::chrono::minutes(5);
+    std::optional<std::string> refreshCve;
+    std::optional<std::string> traceFile;
+    std::optional<std::string> metricsFile;
+    bool profile = false;
+    bool refreshTracker = false;
+    bool sync = false;
     int parsed = 0;
+    const auto durationOption = [&](int i, std::chrono::seconds& duration) {
+        const auto parsedDuration = cveinfo::utils::parseDuration(argv[i + 1]);
+        if (!parsedDuration) {
+            spdlog::error("Invalid duration for {}: {}", argv[i], argv[i + 1]);
+            return false;
+        }
+        duration = *parsedDuration;
+        return true;
+    };
     for (int i = 1; i < argc; ++i) {
         if (*argv[i] != '-') {
             break;
@@ -170,13 +233,113 @@ int main(const int argc, const char** argv) {
         }
         if (argv[i] == "-v"s || argv[i] == "--no-cvss"s) {
             ++parsed;
-            no_cvss = true;
+            options.noCvss = true;
+        } else if (argv[i] == "-V"s || argv[i] == "--verbose"s) {
+            ++parsed;
+            logger->set_level(spdlog::level::debug);
         } else if ((argv[i] == "-c"s || argv[i] == "--codename"s) && i + 1 < argc) {
-            codename = argv[i + 1];
+            options.codename = argv[i + 1];
             parsed += 2;
             ++i;
         } else if ((argv[i] == "-k"s || argv[i] == "--api-key"s) && i + 1 < argc) {
-            apiKey = argv[i + 1];
+            options.apiKey = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "-s"s || argv[i] == "--sync"s) {
+            ++parsed;
+            sync = true;
+        } else if ((argv[i] == "-j"s || argv[i] == "--jobs"s) && i + 1 < argc) {
+            options.jobs = std::max(std::strtoul(argv[i + 1], nullptr, 10), 1UL);
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--cache-size"s && i + 1 < argc) {
+            options.cacheSize = std::max(std::strtoull(argv[i + 1], nullptr, 10), 1ULL) * 1024 * 1024;
+            parsed += 2;
+            ++i;
+        } else if ((argv[i] == "-p"s || argv[i] == "--package"s) && i + 1 < argc) {
+            packageQuery = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if ((argv[i] == "--cpe"s || argv[i] == "--cpe-match"s) && i + 1 < argc) {
+            cpeQueries.push_back(cveinfo::cpe::Query{ argv[i + 1], argv[i] == "--cpe-match"s });
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--export"s && i + 1 < argc) {
+            exportFile = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--import"s && i + 1 < argc) {
+            importFile = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--watch"s && i + 1 < argc) {
+            watchFile = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--watch-interval"s && i + 1 < argc) {
+            if (!durationOption(i, watchInterval)) {
+                return 1;
+            }
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--serve"s && i + 1 < argc) {
+            socketPath = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--scan"s && i + 1 < argc) {
+            statusFile = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--sbom"s && i + 1 < argc) {
+            sbomFile = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--status"s && i + 1 < argc) {
+            options.status = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if ((argv[i] == "--tracker-max-age"s || argv[i] == "--tracker-max-stale"s ||
+                    argv[i] == "--nvd-max-age"s || argv[i] == "--nvd-max-stale"s) &&
+                   i + 1 < argc) {
+            auto& freshness = argv[i][2] == 't' ? options.trackerFreshness : options.nvdFreshness;
+            const bool maxAge = std::string_view(argv[i]).ends_with("-max-age");
+            if (!durationOption(i, maxAge ? freshness.maxAge : freshness.maxStale)) {
+                return 1;
+            }
+            parsed += 2;
+            ++i;
+        } else if ((argv[i] == "--nvd-url"s || argv[i] == "--tracker-url"s ||
+                    argv[i] == "--nvd-rate-limit"s || argv[i] == "--ca-bundle"s) &&
+                   i + 1 < argc) {
+            // Passed on through the environment, so the background refresh processes use them as well
+            const auto variable = argv[i] == "--nvd-url"s          ? cveinfo::endpoints::NVD_URL_ENV
+                                  : argv[i] == "--tracker-url"s    ? cveinfo::endpoints::TRACKER_URL_ENV
+                                  : argv[i] == "--nvd-rate-limit"s ? cveinfo::endpoints::NVD_RATE_LIMIT_ENV
+                                                                   : cveinfo::endpoints::CA_BUNDLE_ENV;
+            setenv(variable, argv[i + 1], 1);
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--profile"s) {
+            ++parsed;
+            profile = true;
+        } else if (argv[i] == "--trace"s && i + 1 < argc) {
+            traceFile = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--metrics"s && i + 1 < argc) {
+            metricsFile = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if (argv[i] == "--refresh-tracker"s) {
+            // Internal, run by the background refresh of a stale database
+            ++parsed;
+            refreshTracker = true;
+        } else if (argv[i] == "--refresh-cve"s && i + 1 < argc) {
+            refreshCve = argv[i + 1];
+            parsed += 2;
+            ++i;
+        } else if ((argv[i] == "-b"s || argv[i] == "--batch"s) && i + 1 < argc) {
+            batchFile = argv[i + 1];
             parsed += 2;
             ++i;
         } else {
@@ -185,18 +348,117 @@ int main(const int argc, const char** argv) {
         }
     }
 
+    if (!options.apiKey) {
+        // How the background refresh processes get it, see nist::getCveDescription()
+        options.apiKey = cveinfo::endpoints::nvdApiKey();
+    }
+
+    if (refreshTracker || refreshCve) {
+        logger->set_pattern("[%Y-%m-%d %H:%M:%S] [%l] %v");
+        if (refreshCve) {
+            const auto cveId = cveinfo::CveId::parse(*refreshCve);
+            if (!cveId) {
+                spdlog::error("Malformed CVE ID: {}", *refreshCve);
+                return 1;
+            }
+            cveinfo::nist::Store store(cveinfo::nist::Store::defaultPath(), options.cacheSize);
+            return cveinfo::nist::refreshCveDescription(*cveId, options.apiKey, store) ? 0 : 1;
+        }
+        using cveinfo::debian::DebianSecurityTracker;
+        return DebianSecurityTracker::refresh(options.codename, options.trackerFreshness) ? 0 : 1;
+    }
+
+    // Reported when main() returns, whichever mode ran
+    std::optional<cveinfo::profile::Report> report;
+    report.emplace(profile, traceFile, metricsFile);
+
+    if (sync) {
+        cveinfo::nist::Store store(cveinfo::nist::Store::defaultPath(), options.cacheSize);
+        cveinfo::nist::Fetcher fetcher(options.apiKey, options.jobs);
+        const bool synced = cveinfo::nist::Mirror(store).sync(fetcher);
+        fetcher.logStats();
+        return synced ? 0 : 1;
+    }
+
+    if (exportFile) {
+        return cveinfo::snapshot::exportTo(*exportFile, options);
+    }
+
+    if (importFile) {
+        return cveinfo::snapshot::importFrom(*importFile, options);
+    }
+
+    if (socketPath) {
+        return cveinfo::server::run(*socketPath, options);
+    }
+
+    if (watchFile) {
+        return cveinfo::watch::run(*watchFile, watchInterval, std::cout, options);
+    }
+
+    if (statusFile) {
+        return cveinfo::scan::run(*statusFile, std::cout, options);
+    }
+
+    if (sbomFile) {
+        return cveinfo::sbom::run(*sbomFile, std::cout, options);
+    }
+
+    if (packageQuery) {
+        return cveinfo::package::run(*packageQuery, std::cout, options);
+    }
+
+    if (!cpeQueries.empty()) {
+        return cveinfo::cpe::run(cpeQueries, std::cout, options);
+    }
+
+    if (batchFile) {
+        if (*batchFile == "-") {
+            return cveinfo::batch::run(std::cin, std::cout, options);
+        }
+        std::ifstream input(*batchFile);
+        if (!input) {
+            spdlog::error("Failed to open {}", *batchFile);
+            return 1;
+        }
+        return cveinfo::batch::run(input, std::cout, options);
+    }
+
     if (argc < parsed + 2) {
         printUsage(argc > 0 ? basename(argv[0]) : "cveinfo");
         return 1;
     }
-    const std::string cveId = argv[parsed + 1];
+    // Checked before anything is downloaded, a malformed ID wouldn't be found anyway
+    const auto cveId = cveinfo::CveId::parse(argv[parsed + 1]);
+    if (!cveId) {
+        spdlog::error("Malformed CVE ID: {}", argv[parsed + 1]);
+        return 1;
+    }
     std::optional<std::string> packageName =
         argc > parsed + 2 ? std::optional(argv[parsed + 2]) : std::nullopt;
 
-    const auto cveDescription = cveinfo::nist::getCveDescription(cveId, apiKey);
+    // Neither source depends on the other, the tracker is refreshed and loaded while NVD is queried. On a
+    // thread of its own rather than through std::async, whose future would hold up a failed NVD lookup until
+    // the tracker is loaded.
+    std::packaged_task<cveinfo::debian::DebianSecurityTracker()> loadTracker(
+        [codename = options.codename, freshness = options.trackerFreshness] {
+            return cveinfo::debian::DebianSecurityTracker(codename, freshness);
+        });
+    auto tracker = loadTracker.get_future();
+    std::thread trackerThread(std::move(loadTracker));
+
+    cveinfo::nist::Store store(cveinfo::nist::Store::defaultPath(), options.cacheSize);
+    const auto cveDescription =
+        cveinfo::nist::getCveDescription(*cveId, options.apiKey, store, options.nvdFreshness);
     if (!cveDescription) {
-        return 1;
+        // Exits without waiting for the tracker. Returning would run the static destructors while its thread
+        // may still be downloading or indexing; it writes to temporary files, which are moved into place once
+        // complete, so it's no worse than an interrupted run.
+        report.reset();
+        spdlog::shutdown();
+        std::_Exit(1);
     }
-    print(*cveDescription, no_cvss);
-    print(cveinfo::debian::DebianSecurityTracker(codename), cveId, packageName);
+    print(*cveDescription, options.noCvss);
+    print(tracker.get(), *cveId, packageName);
+    trackerThread.join();
 }
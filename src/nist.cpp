@@ -1,136 +1,277 @@
 #include "cveinfo/cve/nist.hpp"
 
-#include "cveinfo/utils/json.hpp"
-#include "cveinfo/utils/utils.hpp"
+#include "cveinfo/changes.hpp"
+#include "cveinfo/cve/NistFetcher.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/schema.hpp"
+#include "cveinfo/endpoints.hpp"
+#include "cveinfo/profile.hpp"
+#include "cveinfo/refresh.hpp"
 
-#include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
 #include <spdlog/fmt/chrono.h>
 #include <spdlog/spdlog.h>
 
 #include <chrono>
-#include <fstream>
+#include <memory>
+#include <vector>
 
-using namespace std::chrono_literals;
 using namespace cveinfo;
 using nlohmann::json;
 
-namespace detail {
-inline std::nullopt_t handleNonOkStatusCode(long code, const std::string& cveId) {
-    switch (code) {
-    case 403:
-        spdlog::error("{} - request forbidden: try limiting the request frequency", cveId);
-        return std::nullopt;
-    case 404:
-        spdlog::error("{} not found in the NIST database", cveId);
-        return std::nullopt;
-    case 503:
-        spdlog::error("Couldn't retrieve infornation about {} - NIST database temporarily unavailable",
-                      cveId);
-        return std::nullopt;
-    case 500:
-        spdlog::error("Couldn't retrieve infornation about {} - internal server error in the NIST database",
-                      cveId);
-        return std::nullopt;
-    default:
-        spdlog::error("Couldn't retrieve infornation about {} - status code {}", cveId, code);
-        return std::nullopt;
-    }
-}
+namespace {
+
+// Maximum page size allowed by the NVD API
+constexpr std::size_t RESULTS_PER_PAGE = 2000;
 
-static std::optional<std::string> fetchFromNist(const std::string& cveId,
-                                                const std::optional<std::string>& apiKey) {
+std::optional<nist::CveDescription> describe(CveId cveId, const json& cveInfo) {
     try {
-        int attempts = 3;
-        cpr::Response r;
-        cpr::Header apiKeyHeader;
-        if (apiKey) {
-            apiKeyHeader.emplace("apiKey", *apiKey);
-        }
-        while (attempts-- > 0) {
-            r = cpr::Get(cpr::Url{ "https://services.nvd.nist.gov/rest/json/cves/2.0?cveId=" + cveId },
-                         cpr::VerifySsl{ false },
-                         apiKeyHeader);
-
-            // If the response is "forbidden", it probably means we're sending too many requests.
-            // Let's wait for a bit before issuing another request.
-            if (r.status_code == 403) {
-                std::this_thread::sleep_for(5s * (3 - attempts));
-                continue;
-            }
-            if (r.status_code != 200) {
-                return handleNonOkStatusCode(r.status_code, cveId);
+        if (const auto* cve = nist::schema::FIRST_CVE.find(cveInfo)) {
+            auto desc = nist::parseCve(*cve);
+            desc.cveId = cveId;
+            if (!nist::schema::CVSS_V31.find(*cve)) {
+                spdlog::error("Failed to get CVSS for {}", cveId);
             }
-            return r.text;
+            return desc;
         }
-        return handleNonOkStatusCode(r.status_code, cveId);
+        spdlog::error("Failed to get info for {}: CVE not found", cveId);
+        return nist::CveDescription{ cveId, std::nullopt, std::nullopt, std::nullopt, std::nullopt };
     } catch (const std::exception& e) {
-        spdlog::error("Couldn't retrieve infornation about {} - {}", cveId, e.what());
+        spdlog::error("Failed to get {} info: {}", cveId, e.what());
         return std::nullopt;
     }
 }
 
-} // namespace detail
+utils::Freshness::State freshnessOf(const std::optional<nist::Store::Entry>& cached,
+                                    const utils::Freshness& freshness) {
+    // Mirrored records are kept up to date by the mirror synchronization
+    if (cached && (cached->flags & nist::Store::MIRRORED)) {
+        return utils::Freshness::State::FRESH;
+    }
+    return freshness.of(cached ? std::optional(std::chrono::system_clock::now() - cached->fetched)
+                               : std::nullopt);
+}
 
-static std::optional<json> getCveInfo(const std::string& cveId, const std::optional<std::string>& apiKey) {
+/// Lease of refreshing the record of @p cveId
+std::optional<refresh::Lease> tryLease(CveId cveId) {
+    // One byte of the lock file per CVE, a collision just skips a refresh. Consecutive IDs are spread out
+    // by a multiplicative hash.
+    const std::uint64_t hash = cveId.value() * 0x9e3779b97f4a7c15;
+    return refresh::Lease::tryAcquire(utils::createCveInfoDir() / "nvd.refresh.lock", hash >> 24);
+}
+
+std::optional<nist::CveDescription> onFetched(CveId cveId,
+                                              nist::Store& store,
+                                              const std::optional<nist::Store::Entry>& cached,
+                                              const std::optional<std::string>& jsonBody) {
     try {
-        const std::filesystem::path cachedFile = utils::createCveInfoDir() / cveId;
-        const bool exists = std::filesystem::exists(cachedFile);
-        if (!exists || cachedFile == utils::OlderThan(1h)) {
-            const auto jsonBody = detail::fetchFromNist(cveId, apiKey);
-            if (jsonBody) {
-                if (!(std::ofstream(cachedFile) << *jsonBody)) {
-                    spdlog::warn("Failed to cache {} to {}", cveId, cachedFile.string());
+        if (jsonBody) {
+            auto desc = [&] {
+                const profile::Scope scope("nvd.parse");
+                return describe(cveId, json::parse(*jsonBody));
+            }();
+            if (desc) {
+                // The record it replaces tells what changed
+                const auto previous = cached ? cached : store.get(cveId);
+                store.put(*desc, std::chrono::system_clock::now());
+                if (previous) {
+                    if (const auto change = changes::diff(previous->description, *desc)) {
+                        changes::publish({ *change });
+                    }
                 }
-                return json::parse(*jsonBody);
             }
+            return desc;
         }
-        if (!exists) {
+        if (!cached) {
             return std::nullopt;
         }
-        if (cachedFile == utils::OlderThan(1h)) {
-            spdlog::warn("Using local cache from {} for {}", utils::lastWriteTime(cachedFile), cveId);
-        }
-        return json::parse(std::ifstream(cachedFile));
+        spdlog::warn("Using local cache from {} for {}", cached->fetched, cveId);
+        return cached->description;
     } catch (const std::exception& e) {
         spdlog::error("Couldn't retrieve infornation about {} - {}", cveId, e.what());
         return std::nullopt;
     }
 }
 
-std::optional<nist::CveDescription> nist::getCveDescription(const std::string& cveId,
-                                                            const std::optional<std::string>& apiKey) {
-    const auto cveInfo = getCveInfo(cveId, apiKey);
-    if (!cveInfo) {
+/// Parses @p body and hands it to @p onPage, returns the total number of results or std::nullopt on failure
+std::optional<std::size_t> processPage(const std::optional<std::string>& body,
+                                       const std::string& subject,
+                                       const nist::PageCallback& onPage) {
+    if (!body) {
         return std::nullopt;
     }
     try {
-        nist::CveDescription desc;
-        desc.cveId = cveId;
-
-        if (const auto cve = utils::getAs<json>(*cveInfo, "/vulnerabilities/0/cve")) {
-            if (const auto cvssData = utils::getAs<json>(*cve, "/metrics/cvssMetricV31/0/cvssData")) {
-                desc.vectorString = utils::getAs<std::string>(*cvssData, "/vectorString");
-                desc.severity = utils::getAs<std::string>(*cvssData, "/baseSeverity");
-                desc.score = utils::getAs<float>(*cvssData, "/baseScore");
-            } else {
-                spdlog::error("Failed to get CVSS for {}", cveId);
+        const auto page = [&] {
+            const profile::Scope scope("nvd.parse");
+            return json::parse(*body);
+        }();
+        if (!onPage(page)) {
+            return std::nullopt;
+        }
+        return nist::schema::TOTAL_RESULTS(page).value_or(0);
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to process {}: {}", subject, e.what());
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+nist::CveDescription nist::parseCve(const json& cve) {
+    CveDescription desc;
+    desc.cveId = CveId::parse(schema::ID(cve).value_or("")).value_or(CveId());
+
+    if (const auto* cvssData = schema::CVSS_V31.find(cve)) {
+        desc.vectorString = schema::VECTOR_STRING(*cvssData);
+        desc.severity = schema::BASE_SEVERITY(*cvssData);
+        desc.score = schema::BASE_SCORE(*cvssData);
+    }
+
+    if (const auto* descriptions = schema::DESCRIPTIONS.find(cve); descriptions && descriptions->is_array()) {
+        for (const auto& description : *descriptions) {
+            if (schema::LANG(description) == "en") {
+                desc.description = schema::VALUE(description);
             }
+        }
+    }
+    return desc;
+}
 
-            if (const auto descriptions = utils::getAs<json>(*cve, "/descriptions")) {
-                for (const auto& description : *descriptions) {
-                    if (auto lang = utils::getAs<std::string>(description, "/lang"); lang == "en") {
-                        desc.description = utils::getAs<std::string>(description, "/value");
-                    }
-                }
+std::vector<nist::CveDescription> nist::parsePage(const json& page) {
+    std::vector<CveDescription> descriptions;
+    const auto* vulnerabilities = schema::VULNERABILITIES.find(page);
+    if (!vulnerabilities || !vulnerabilities->is_array()) {
+        return descriptions;
+    }
+    descriptions.reserve(vulnerabilities->size());
+    for (const auto& vulnerability : *vulnerabilities) {
+        if (const auto* cve = schema::CVE.find(vulnerability)) {
+            auto description = parseCve(*cve);
+            if (!description.cveId.empty()) {
+                descriptions.push_back(std::move(description));
             }
-        } else {
-            spdlog::error("Failed to get info for {}: CVE not found", cveId);
         }
+    }
+    return descriptions;
+}
 
-        return desc;
-    } catch (const std::exception& e) {
-        spdlog::error("Failed to get {} info: {}", cveId, e.what());
-        return std::nullopt;
+bool nist::fetchPages(Fetcher& fetcher,
+                      const std::string& query,
+                      const std::string& subject,
+                      PageCallback onPage) {
+    const auto pageQuery = [&query](std::size_t startIndex) {
+        return fmt::format("{}{}resultsPerPage={}&startIndex={}",
+                           query,
+                           query.empty() ? "" : "&",
+                           RESULTS_PER_PAGE,
+                           startIndex);
+    };
+    const auto pageSubject = [&subject](std::size_t startIndex) {
+        return fmt::format("{} page {}", subject, startIndex / RESULTS_PER_PAGE);
+    };
+
+    const auto total = processPage(fetcher.fetch(pageQuery(0), pageSubject(0)).get(), pageSubject(0), onPage);
+    if (!total) {
+        return false;
+    }
+    std::vector<std::future<bool>> pages;
+    for (std::size_t start = RESULTS_PER_PAGE; start < *total; start += RESULTS_PER_PAGE) {
+        auto promise = std::make_shared<std::promise<bool>>();
+        pages.push_back(promise->get_future());
+        // The pages are all waited for below, so the callbacks can refer to onPage
+        fetcher.fetch(pageQuery(start),
+                      pageSubject(start),
+                      [promise, &onPage, pageSubject = pageSubject(start)](std::optional<std::string> body) {
+                          promise->set_value(processPage(body, pageSubject, onPage).has_value());
+                      });
+    }
+
+    bool complete = true;
+    for (auto& page : pages) {
+        complete = page.get() && complete;
+    }
+    return complete;
+}
+
+void nist::getCveDescriptionAsync(CveId cveId,
+                                 Fetcher& fetcher,
+                                 Store& store,
+                                 const utils::Freshness& freshness,
+                                 DescriptionCallback done) {
+    auto cached = store.get(cveId);
+    switch (freshnessOf(cached, freshness)) {
+    case utils::Freshness::State::FRESH:
+        profile::add(profile::Counter::CACHE_HITS);
+        done(std::move(cached->description));
+        return;
+    case utils::Freshness::State::STALE:
+        profile::add(profile::Counter::CACHE_STALE);
+        done(cached->description);
+        // Skipped if this or another process is revalidating the record already
+        if (auto lease = tryLease(cveId)) {
+            fetcher.fetch("cveId=" + cveId.str(),
+                          cveId.str(),
+                          [cveId, &store, lease = std::make_shared<refresh::Lease>(std::move(*lease))](
+                              std::optional<std::string> jsonBody) {
+                              if (jsonBody) {
+                                  onFetched(cveId, store, std::nullopt, jsonBody);
+                              }
+                          });
+        }
+        return;
+    case utils::Freshness::State::EXPIRED:
+        profile::add(profile::Counter::CACHE_MISSES);
+        break;
+    }
+
+    fetcher.fetch("cveId=" + cveId.str(),
+                  cveId.str(),
+                  [done = std::move(done), cveId, &store, cached = std::move(cached)](
+                      std::optional<std::string> jsonBody) {
+                      done(onFetched(cveId, store, cached, jsonBody));
+                  });
+}
+
+std::future<std::optional<nist::CveDescription>>
+nist::getCveDescriptionAsync(CveId cveId,
+                             Fetcher& fetcher,
+                             Store& store,
+                             const utils::Freshness& freshness) {
+    auto promise = std::make_shared<std::promise<std::optional<CveDescription>>>();
+    auto future = promise->get_future();
+    getCveDescriptionAsync(cveId, fetcher, store, freshness, [promise](std::optional<CveDescription> desc) {
+        promise->set_value(std::move(desc));
+    });
+    return future;
+}
+
+std::optional<nist::CveDescription> nist::getCveDescription(CveId cveId,
+                                                            const std::optional<std::string>& apiKey,
+                                                            Store& store,
+                                                            const utils::Freshness& freshness) {
+    const auto cached = store.get(cveId);
+    if (freshnessOf(cached, freshness) == utils::Freshness::State::STALE) {
+        profile::add(profile::Counter::CACHE_STALE);
+        std::vector<std::string> environment;
+        if (apiKey) {
+            environment.push_back(fmt::format("{}={}", endpoints::NVD_API_KEY_ENV, *apiKey));
+        }
+        refresh::spawn({ "--refresh-cve", cveId.str() }, environment);
+        return cached->description;
+    }
+    Fetcher fetcher(apiKey, 1);
+    return getCveDescriptionAsync(cveId, fetcher, store, freshness).get();
+}
+
+bool nist::refreshCveDescription(CveId cveId,
+                                 const std::optional<std::string>& apiKey,
+                                 Store& store) {
+    const auto lease = tryLease(cveId);
+    if (!lease) {
+        spdlog::debug("{} is being refreshed by another process", cveId);
+        return true;
     }
+    Fetcher fetcher(apiKey, 1);
+    const auto jsonBody = fetcher.fetch("cveId=" + cveId.str(), cveId.str()).get();
+    return jsonBody && onFetched(cveId, store, std::nullopt, jsonBody);
 }
@@ -0,0 +1,59 @@
+#include "cveinfo/package.hpp"
+
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/serialization.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+int package::run(const std::string& packageName, std::ostream& output, const Options& options) {
+    const debian::DebianSecurityTracker tracker(options.codename, options.trackerFreshness);
+    auto infos = tracker.getPackageInfo(packageName, options.status);
+    // Not a source package name, e.g. a binary package name from an SBOM
+    if (infos.empty()) {
+        const auto matches = tracker.resolvePackage(packageName, 1);
+        if (!matches.empty() && matches.front().name != packageName) {
+            spdlog::warn("Package {} not in the debian security tracker, using {} (score {:.2f})",
+                         packageName,
+                         matches.front().name,
+                         matches.front().score);
+            infos = tracker.getPackageInfo(std::string(matches.front().name), options.status);
+        }
+    }
+    if (infos.empty()) {
+        spdlog::error("No CVEs found for package {}", packageName);
+        return 1;
+    }
+
+    nist::Store store(nist::Store::defaultPath(), options.cacheSize);
+    std::size_t cached = 0;
+    for (const auto& info : infos) {
+        json result = { { "cveId", info.cveId.str() } };
+        if (const auto entry = store.get(info.cveId)) {
+            json nvd = entry->description;
+            nvd.erase("cveId");
+            nvd.erase("description");
+            if (options.noCvss) {
+                nvd.erase("vectorString");
+            }
+            result["nvd"] = std::move(nvd);
+            ++cached;
+        } else {
+            result["nvd"] = nullptr;
+        }
+        result["codenames"] = info.codenames;
+        output << result.dump() << '\n';
+    }
+    output.flush();
+    spdlog::debug("Found {} CVEs of {}, {} of them in the NVD cache", infos.size(), packageName, cached);
+
+    if (!output) {
+        spdlog::error("Failed to write package results");
+        return 1;
+    }
+    return 0;
+}
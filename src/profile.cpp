@@ -0,0 +1,242 @@
+#include "cveinfo/profile.hpp"
+
+#include "cveinfo/utils/utils.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace cveinfo;
+using Clock = std::chrono::steady_clock;
+
+std::atomic<bool> profile::detail::gEnabled = false;
+std::atomic<std::uint64_t> profile::detail::gCounters[static_cast<std::size_t>(Counter::COUNT)] = {};
+
+namespace {
+
+struct CounterInfo {
+    std::string_view name;
+    std::string_view summary;
+    std::string_view help;
+};
+
+// In the order of profile::Counter
+constexpr std::array<CounterInfo, static_cast<std::size_t>(profile::Counter::COUNT)> COUNTERS = { {
+    { "cveinfo_http_requests_total", "HTTP requests", "HTTP requests sent" },
+    { "cveinfo_http_downloaded_bytes_total", "Bytes downloaded", "Bytes of HTTP response bodies received" },
+    { "cveinfo_http_rate_limited_total", "Rate limited responses", "Responses asking to slow down" },
+    { "cveinfo_http_retries_total", "Retries", "Rate limited requests sent again" },
+    { "cveinfo_http_connections_opened_total", "Connections opened", "HTTP connections opened" },
+    { "cveinfo_http_connections_reused_total", "Connections reused", "Requests sent on an open connection" },
+    { "cveinfo_nvd_cache_hits_total", "NVD cache hits", "NVD records answered from the cache" },
+    { "cveinfo_nvd_cache_misses_total", "NVD cache misses", "NVD records missing or expired in the cache" },
+    { "cveinfo_nvd_cache_stale_total", "NVD cache stale uses", "Stale NVD records answered while refreshed" },
+    { "cveinfo_packages_scanned_total", "Packages scanned", "Installed source packages scanned" },
+    { "cveinfo_sbom_components_scanned_total", "SBOM components scanned", "SBOM components scanned" },
+    { "cveinfo_queries_total", "Queries", "Batch and server queries answered" },
+} };
+
+// Enough for any realistic run, a runaway trace just stops growing
+constexpr std::size_t MAX_TRACE_EVENTS = 1 << 20;
+
+struct Phase {
+    std::uint64_t count = 0;
+    Clock::duration total{};
+    Clock::duration max{};
+};
+
+struct TraceEvent {
+    const char* phase;
+    std::uint32_t thread;
+    Clock::time_point start;
+    Clock::duration duration;
+};
+
+const Clock::time_point gStarted = Clock::now();
+
+std::mutex gMutex;
+bool gTrace = false;
+std::map<std::string_view, Phase> gPhases;
+std::vector<TraceEvent> gEvents;
+
+/// Small sequential thread IDs read better in trace viewers than pthread IDs
+std::uint32_t threadId() {
+    static std::atomic<std::uint32_t> next = 1;
+    thread_local const std::uint32_t id = next++;
+    return id;
+}
+
+double seconds(Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+double microseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+std::string formatDuration(Clock::duration duration) {
+    const auto s = seconds(duration);
+    return s >= 1 ? fmt::format("{:.2f}s", s) : fmt::format("{:.2f}ms", s * 1000);
+}
+
+} // namespace
+
+void profile::record(const char* phase, Clock::time_point start) {
+    if (!enabled()) {
+        return;
+    }
+    const auto duration = Clock::now() - start;
+    std::lock_guard<std::mutex> guard(gMutex);
+    auto& aggregate = gPhases[phase];
+    ++aggregate.count;
+    aggregate.total += duration;
+    aggregate.max = std::max(aggregate.max, duration);
+    if (gTrace && gEvents.size() < MAX_TRACE_EVENTS) {
+        gEvents.push_back(TraceEvent{ phase, threadId(), start, duration });
+    }
+}
+
+void profile::enable(bool trace) {
+    {
+        std::lock_guard<std::mutex> guard(gMutex);
+        gTrace = trace;
+    }
+    detail::gEnabled = true;
+}
+
+void profile::printSummary() {
+    std::vector<std::pair<std::string_view, Phase>> phases;
+    {
+        std::lock_guard<std::mutex> guard(gMutex);
+        phases.assign(std::begin(gPhases), std::end(gPhases));
+    }
+    std::sort(std::begin(phases), std::end(phases), [](const auto& lhs, const auto& rhs) {
+        return lhs.second.total > rhs.second.total;
+    });
+
+    fmt::print(stderr,
+               "Profile: {} wall time, {} KiB peak RSS\n",
+               formatDuration(Clock::now() - gStarted),
+               utils::peakResidentSetSize() / 1024);
+    if (!phases.empty()) {
+        fmt::print(stderr, "  {:<24}{:>8}{:>12}{:>12}{:>12}\n", "Phase", "Count", "Total", "Mean", "Max");
+    }
+    for (const auto& [name, phase] : phases) {
+        fmt::print(stderr,
+                   "  {:<24}{:>8}{:>12}{:>12}{:>12}\n",
+                   name,
+                   phase.count,
+                   formatDuration(phase.total),
+                   formatDuration(phase.total / static_cast<Clock::rep>(phase.count)),
+                   formatDuration(phase.max));
+    }
+    for (std::size_t i = 0; i < COUNTERS.size(); ++i) {
+        if (const auto count = value(static_cast<Counter>(i))) {
+            fmt::print(stderr, "  {:<24}{:>8}\n", COUNTERS[i].summary, count);
+        }
+    }
+}
+
+bool profile::writeTrace(const std::filesystem::path& path) {
+    std::ofstream output(path, std::ios::trunc);
+    const auto pid = getpid();
+    output << R"({"displayTimeUnit":"ms","traceEvents":[)";
+    {
+        std::lock_guard<std::mutex> guard(gMutex);
+        for (std::size_t i = 0; i < gEvents.size(); ++i) {
+            const auto& event = gEvents[i];
+            output << fmt::format(R"({}{{"name":"{}","cat":"cveinfo","ph":"X","ts":{:.3f},"dur":{:.3f},)"
+                                  R"("pid":{},"tid":{}}})",
+                                  i > 0 ? ",\n" : "\n",
+                                  event.phase,
+                                  microseconds(event.start - gStarted),
+                                  microseconds(event.duration),
+                                  pid,
+                                  event.thread);
+        }
+        if (gEvents.size() == MAX_TRACE_EVENTS) {
+            spdlog::warn("Trace truncated to its first {} events", MAX_TRACE_EVENTS);
+        }
+    }
+    // The final counter values, shown as a counter track at the end of the run
+    output << ",\n"
+           << fmt::format(R"({{"name":"counters","ph":"C","ts":{:.3f},"pid":{},"args":{{)",
+                          microseconds(Clock::now() - gStarted),
+                          pid);
+    for (std::size_t i = 0; i < COUNTERS.size(); ++i) {
+        output << (i > 0 ? "," : "") << '"' << COUNTERS[i].name << "\":" << value(static_cast<Counter>(i));
+    }
+    output << "}}]}\n";
+    if (!output) {
+        spdlog::error("Failed to write trace to {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+std::string profile::prometheus() {
+    std::string text;
+    auto out = std::back_inserter(text);
+    for (std::size_t i = 0; i < COUNTERS.size(); ++i) {
+        fmt::format_to(out,
+                       "# HELP {0} {1}\n# TYPE {0} counter\n{0} {2}\n",
+                       COUNTERS[i].name,
+                       COUNTERS[i].help,
+                       value(static_cast<Counter>(i)));
+    }
+    fmt::format_to(out,
+                   "# HELP cveinfo_peak_rss_bytes Peak resident set size\n"
+                   "# TYPE cveinfo_peak_rss_bytes gauge\ncveinfo_peak_rss_bytes {}\n",
+                   utils::peakResidentSetSize());
+
+    std::lock_guard<std::mutex> guard(gMutex);
+    if (!gPhases.empty()) {
+        text += "# HELP cveinfo_phase_seconds Time spent per phase\n# TYPE cveinfo_phase_seconds summary\n";
+    }
+    for (const auto& [name, phase] : gPhases) {
+        fmt::format_to(out,
+                       "cveinfo_phase_seconds_sum{{phase=\"{0}\"}} {1:.6f}\n"
+                       "cveinfo_phase_seconds_count{{phase=\"{0}\"}} {2}\n",
+                       name,
+                       seconds(phase.total),
+                       phase.count);
+    }
+    text += "# EOF\n";
+    return text;
+}
+
+profile::Report::Report(bool summary,
+                        std::optional<std::filesystem::path> traceFile,
+                        std::optional<std::filesystem::path> metricsFile)
+    : mSummary(summary)
+    , mTraceFile(std::move(traceFile))
+    , mMetricsFile(std::move(metricsFile)) {
+    if (mSummary || mTraceFile || mMetricsFile) {
+        enable(mTraceFile.has_value());
+    }
+}
+
+profile::Report::~Report() {
+    try {
+        if (mSummary) {
+            printSummary();
+        }
+        if (mTraceFile) {
+            writeTrace(*mTraceFile);
+        }
+        if (mMetricsFile && !(std::ofstream(*mMetricsFile, std::ios::trunc) << prometheus())) {
+            spdlog::error("Failed to write metrics to {}", mMetricsFile->string());
+        }
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to report the profile: {}", e.what());
+    }
+}
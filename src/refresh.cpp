@@ -0,0 +1,119 @@
+#include "cveinfo/refresh.hpp"
+
+#include "cveinfo/utils/utils.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace cveinfo;
+using refresh::Lease;
+
+extern char** environ;
+
+namespace {
+
+int lock(const std::filesystem::path& lockPath, std::uint64_t slot, bool wait) {
+    const int fd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, lockPath };
+    }
+    // Open file description locks, unlike POSIX record locks, are exclusive between threads too
+    struct flock range{};
+    range.l_type = F_WRLCK;
+    range.l_whence = SEEK_SET;
+    range.l_start = static_cast<off_t>(slot);
+    range.l_len = 1;
+    while (fcntl(fd, wait ? F_OFD_SETLKW : F_OFD_SETLK, &range) != 0) {
+        const int error = errno;
+        if (error == EINTR) {
+            continue;
+        }
+        ::close(fd);
+        if (!wait && (error == EAGAIN || error == EACCES)) {
+            return -1;
+        }
+        throw std::system_error{ std::error_code{ error, std::system_category() }, lockPath };
+    }
+    return fd;
+}
+
+} // namespace
+
+Lease Lease::acquire(const std::filesystem::path& lockPath, std::uint64_t slot) {
+    return Lease(lock(lockPath, slot, true));
+}
+
+std::optional<Lease> Lease::tryAcquire(const std::filesystem::path& lockPath, std::uint64_t slot) {
+    const int fd = lock(lockPath, slot, false);
+    return fd >= 0 ? std::optional<Lease>(Lease(fd)) : std::nullopt;
+}
+
+Lease::Lease(Lease&& other) noexcept
+    : mFd(std::exchange(other.mFd, -1)) {}
+
+Lease::~Lease() {
+    if (mFd >= 0) {
+        ::close(mFd);
+    }
+}
+
+void refresh::spawn(const std::vector<std::string>& arguments, std::vector<std::string> environment) {
+    const auto logPath = utils::createCveInfoDir() / "refresh.log";
+
+    std::vector<std::string> args = { "cveinfo" };
+    args.insert(std::end(args), std::begin(arguments), std::end(arguments));
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    std::vector<char*> envp;
+    for (char** variable = environ; *variable; ++variable) {
+        const std::string_view entry(*variable);
+        const auto name = entry.substr(0, entry.find('=') + 1);
+        if (std::none_of(std::begin(environment), std::end(environment), [name](const std::string& added) {
+                return added.starts_with(name);
+            })) {
+            envp.push_back(*variable);
+        }
+    }
+    for (auto& variable : environment) {
+        envp.push_back(variable.data());
+    }
+    envp.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(
+        &actions, STDERR_FILENO, logPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    // A session of its own keeps the refresh running when the terminal of the user goes away
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSID);
+
+    pid_t pid;
+    const int error = posix_spawn(&pid, "/proc/self/exe", &actions, &attributes, argv.data(), envp.data());
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0) {
+        spdlog::warn("Failed to start background refresh: {}",
+                     std::error_code(error, std::system_category()).message());
+        return;
+    }
+    // Reaped by the parent if it outlives the refresh, otherwise by init
+    std::thread([pid] { waitpid(pid, nullptr, 0); }).detach();
+}
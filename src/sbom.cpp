@@ -0,0 +1,568 @@
+#include "cveinfo/sbom.hpp"
+
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/NistFetcher.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/nist.hpp"
+#include "cveinfo/cve/serialization.hpp"
+#include "cveinfo/profile.hpp"
+#include "cveinfo/utils/DebianVersion.hpp"
+#include "cveinfo/utils/MappedFile.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <future>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace cveinfo;
+using nlohmann::json;
+using sbom::Component;
+
+namespace {
+
+// Components matched at once; bounds the memory of the results and of the in-flight NVD lookups
+constexpr std::size_t CHUNK_SIZE = 4096;
+
+constexpr std::string_view DEB_PURL_PREFIX = "pkg:deb/";
+constexpr std::string_view CPE_23_PREFIX = "cpe:2.3:";
+
+struct DebianRelease {
+    std::string_view version;
+    std::string_view codename;
+};
+
+// SBOM generators give the release as the version number in the distro qualifier, e.g. distro=debian-12
+constexpr auto DEBIAN_RELEASES = std::to_array<DebianRelease>({
+    { "10", "buster" },
+    { "11", "bullseye" },
+    { "12", "bookworm" },
+    { "13", "trixie" },
+    { "14", "forky" },
+});
+
+/// SAX handler extracting the components of CycloneDX documents (the "components" arrays, nested ones
+/// included) and the packages of SPDX documents, skipping everything else.
+class ComponentParser : public nlohmann::json_sax<json> {
+public:
+    explicit ComponentParser(const sbom::ComponentCallback& onComponent)
+        : mOnComponent(onComponent) {}
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t) override { return true; }
+    bool number_unsigned(number_unsigned_t) override { return true; }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& val) override {
+        if (inComponent()) {
+            auto& component = mComponents.back();
+            if (mKey == "name") {
+                component.name = std::move(val);
+            } else if (mKey == "version" || mKey == "versionInfo") {
+                component.version = std::move(val);
+            } else if (mKey == "purl") {
+                component.purl = std::move(val);
+            } else if (mKey == "cpe") {
+                component.cpe = std::move(val);
+            }
+        } else if (inExternalRef()) {
+            if (mKey == "referenceType") {
+                mReferenceType = std::move(val);
+            } else if (mKey == "referenceLocator") {
+                mReferenceLocator = std::move(val);
+            }
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        const bool component = !mFrames.empty() && mFrames.back().array &&
+                               (mFrames.back().key == "components" || mFrames.back().key == "packages");
+        mFrames.push_back(Frame{ valueKey(), false, component });
+        if (component) {
+            mComponents.emplace_back();
+        } else if (inExternalRef()) {
+            mReferenceType.clear();
+            mReferenceLocator.clear();
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (inExternalRef()) {
+            // SPDX packages give their package URL and CPE name as external references
+            auto& component = mComponents.back();
+            if (mReferenceType == "purl" && !component.purl) {
+                component.purl = std::move(mReferenceLocator);
+            } else if (mReferenceType == "cpe23Type" && !component.cpe) {
+                component.cpe = std::move(mReferenceLocator);
+            }
+        }
+        const bool component = mFrames.back().component;
+        mFrames.pop_back();
+        if (!component) {
+            return true;
+        }
+        auto parsed = std::move(mComponents.back());
+        mComponents.pop_back();
+        return mOnComponent(std::move(parsed));
+    }
+
+    bool start_array(std::size_t) override {
+        mFrames.push_back(Frame{ valueKey(), true, false });
+        return true;
+    }
+
+    bool end_array() override {
+        mFrames.pop_back();
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        mKey = std::move(val);
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        throw std::runtime_error(ex.what());
+    }
+
+private:
+    struct Frame {
+        /// Key of the object or array in its parent object, empty in arrays
+        std::string key;
+        bool array;
+        /// The fields of the object are collected into mComponents.back()
+        bool component;
+    };
+
+    std::string valueKey() const { return mFrames.empty() || mFrames.back().array ? std::string() : mKey; }
+
+    bool inComponent() const { return !mFrames.empty() && mFrames.back().component; }
+
+    /// Whether the current object is an entry of the "externalRefs" of a component
+    bool inExternalRef() const {
+        const auto depth = mFrames.size();
+        return depth >= 3 && !mFrames[depth - 1].array && mFrames[depth - 2].array &&
+               mFrames[depth - 2].key == "externalRefs" && mFrames[depth - 3].component;
+    }
+
+    const sbom::ComponentCallback& mOnComponent;
+    std::vector<Frame> mFrames;
+    std::string mKey;
+    /// Components being parsed, nested ones after the ones containing them
+    std::vector<Component> mComponents;
+    std::string mReferenceType;
+    std::string mReferenceLocator;
+};
+
+std::string percentDecode(std::string_view value) {
+    std::string decoded;
+    decoded.reserve(value.size());
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        const auto* hex = value.data() + i + 1;
+        unsigned char byte = 0;
+        if (value[i] == '%' && i + 2 < value.size() &&
+            std::from_chars(hex, hex + 2, byte, 16).ptr == hex + 2) {
+            decoded += static_cast<char>(byte);
+            i += 2;
+        } else {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+struct DebianPackage {
+    std::string name;
+    std::string version;
+    /// Source package of the upstream qualifier, given when it's named differently than the binary one
+    std::optional<std::string> source;
+    /// Source package version of the upstream qualifier, given when it differs from the binary one
+    std::optional<std::string> sourceVersion;
+    std::optional<std::string> distro;
+};
+
+/// Parses a pkg:deb/debian/<name>@<version>?<qualifiers> package URL, std::nullopt for any other one.
+std::optional<DebianPackage> parseDebianPurl(std::string_view purl) {
+    if (!purl.starts_with(DEB_PURL_PREFIX)) {
+        return std::nullopt;
+    }
+    purl.remove_prefix(DEB_PURL_PREFIX.size());
+    purl = purl.substr(0, purl.find('#'));
+    std::string_view qualifiers;
+    if (const auto question = purl.find('?'); question != std::string_view::npos) {
+        qualifiers = purl.substr(question + 1);
+        purl = purl.substr(0, question);
+    }
+    // Packages of derivatives like ubuntu aren't covered by the debian security tracker
+    const auto slash = purl.find('/');
+    if (slash == std::string_view::npos || percentDecode(purl.substr(0, slash)) != "debian") {
+        return std::nullopt;
+    }
+    purl.remove_prefix(slash + 1);
+
+    DebianPackage package;
+    const auto at = purl.find('@');
+    package.name = percentDecode(purl.substr(0, at));
+    if (at != std::string_view::npos) {
+        package.version = percentDecode(purl.substr(at + 1));
+    }
+    while (!qualifiers.empty()) {
+        const auto ampersand = qualifiers.find('&');
+        const auto qualifier = qualifiers.substr(0, ampersand);
+        qualifiers.remove_prefix(ampersand == std::string_view::npos ? qualifiers.size() : ampersand + 1);
+        const auto equals = qualifier.find('=');
+        if (equals == std::string_view::npos) {
+            continue;
+        }
+        const auto key = qualifier.substr(0, equals);
+        auto value = percentDecode(qualifier.substr(equals + 1));
+        if (key == "upstream") {
+            // upstream=<source> or upstream=<source>@<source version>
+            if (const auto sourceAt = value.find('@'); sourceAt != std::string::npos) {
+                package.sourceVersion = value.substr(sourceAt + 1);
+                value.resize(sourceAt);
+            }
+            package.source = std::move(value);
+        } else if (key == "distro") {
+            package.distro = std::move(value);
+        }
+    }
+    return package;
+}
+
+/// Returns the codename of a distro qualifier, e.g. debian-12, debian-12.4 or bookworm.
+std::optional<std::string> codenameOf(std::string_view distro) {
+    if (distro.starts_with("debian-")) {
+        distro.remove_prefix(std::string_view("debian-").size());
+    }
+    if (distro.empty()) {
+        return std::nullopt;
+    }
+    if (distro.front() < '0' || distro.front() > '9') {
+        return std::string(distro);
+    }
+    const auto major = distro.substr(0, distro.find('.'));
+    for (const auto& release : DEBIAN_RELEASES) {
+        if (release.version == major) {
+            return std::string(release.codename);
+        }
+    }
+    return std::nullopt;
+}
+
+struct CpeProduct {
+    std::string name;
+    std::string version;
+};
+
+/// Returns the product and version of a CPE 2.3 name, std::nullopt if it doesn't name a single version.
+std::optional<CpeProduct> parseCpe(std::string_view cpe) {
+    if (!cpe.starts_with(CPE_23_PREFIX)) {
+        return std::nullopt;
+    }
+    cpe.remove_prefix(CPE_23_PREFIX.size());
+    // part:vendor:product:version:..., the values may contain quoted characters like "\:"
+    std::vector<std::string> fields(1);
+    for (std::size_t i = 0; i < cpe.size() && fields.size() <= 4; ++i) {
+        if (cpe[i] == '\\' && i + 1 < cpe.size()) {
+            fields.back() += cpe[++i];
+        } else if (cpe[i] == ':') {
+            fields.emplace_back();
+        } else {
+            fields.back() += cpe[i];
+        }
+    }
+    if (fields.size() < 4 || fields[2].empty() || fields[3].empty() || fields[3] == "*" || fields[3] == "-") {
+        return std::nullopt;
+    }
+    return CpeProduct{ std::move(fields[2]), std::move(fields[3]) };
+}
+
+/// Source package version a component is matched as
+struct Target {
+    std::string source;
+    std::string version;
+    /// Matched by CPE name, the version is an upstream version
+    bool upstream = false;
+
+    auto operator<=>(const Target&) const = default;
+};
+
+struct Finding {
+    CveId cveId;
+    std::string fixedVersion;
+};
+
+/// Calls @p function with every index below @p count, on all cores.
+template <typename TFunction>
+void parallelFor(std::size_t count, const TFunction& function) {
+    // The indexes are independent, the workers just pick the next one until all are done
+    std::atomic<std::size_t> next = 0;
+    const auto worker = [&] {
+        for (std::size_t i; (i = next++) < count;) {
+            function(i);
+        }
+    };
+    std::vector<std::thread> workers;
+    const auto threads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, count / 16 + 1);
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+class Scanner {
+public:
+    Scanner(const std::filesystem::path& sbomPath, std::ostream& output, const Options& options)
+        : mSbomPath(sbomPath)
+        , mOutput(output)
+        , mOptions(options)
+        , mCodename(options.codename)
+        , mStore(nist::Store::defaultPath(), options.cacheSize)
+        , mFetcher(options.apiKey, options.jobs) {}
+
+    /// Adds @p component to the current chunk and scans the chunk once it's full.
+    bool add(Component&& component) {
+        if (!mCodename && component.purl) {
+            if (const auto package = parseDebianPurl(*component.purl); package && package->distro) {
+                mCodename = codenameOf(*package->distro);
+            }
+        }
+        mChunk.push_back(std::move(component));
+        return mChunk.size() < CHUNK_SIZE || flush();
+    }
+
+    /// Scans the components of the current chunk and writes their results.
+    bool flush() {
+        if (mChunk.empty()) {
+            return true;
+        }
+        if (!mTracker) {
+            // The release is known from the first chunk on, loading the tracker waits for it
+            if (!mCodename) {
+                spdlog::error("Failed to detect the debian release of {}, please specify its codename",
+                              mSbomPath.string());
+                return false;
+            }
+            mTracker.emplace(mCodename, mOptions.trackerFreshness);
+        }
+        profile::add(profile::Counter::COMPONENTS_SCANNED, mChunk.size());
+        mScanned += mChunk.size();
+
+        std::vector<std::optional<Target>> targets(mChunk.size());
+        {
+            const profile::Scope scope("sbom.resolve");
+            parallelFor(mChunk.size(), [&](std::size_t i) { targets[i] = resolve(mChunk[i]); });
+        }
+
+        // The binary packages of a source package version are matched once
+        std::vector<Target> sources;
+        for (const auto& target : targets) {
+            if (target) {
+                sources.push_back(*target);
+            }
+        }
+        std::sort(std::begin(sources), std::end(sources));
+        sources.erase(std::unique(std::begin(sources), std::end(sources)), std::end(sources));
+        std::vector<std::vector<Finding>> findings(sources.size());
+        {
+            const profile::Scope scope("sbom.match");
+            parallelFor(sources.size(), [&](std::size_t i) { findings[i] = match(sources[i]); });
+        }
+
+        // The NVD records new to the chunk are requested together, the cached ones are answered right away
+        {
+            const profile::Scope scope("sbom.nvd");
+            std::map<CveId, std::future<std::optional<nist::CveDescription>>> descriptions;
+            for (const auto& sourceFindings : findings) {
+                for (const auto& finding : sourceFindings) {
+                    if (!mNvd.contains(finding.cveId) && !descriptions.contains(finding.cveId)) {
+                        descriptions.emplace(finding.cveId,
+                                             nist::getCveDescriptionAsync(
+                                                 finding.cveId, mFetcher, mStore, mOptions.nvdFreshness));
+                    }
+                }
+            }
+            for (auto& [cveId, description] : descriptions) {
+                mNvd.emplace(cveId, toJson(description.get()));
+            }
+        }
+
+        const auto findingsOf = [&](std::size_t i) -> const std::vector<Finding>& {
+            const auto source = std::lower_bound(std::begin(sources), std::end(sources), *targets[i]);
+            return findings[static_cast<std::size_t>(source - std::begin(sources))];
+        };
+        std::vector<std::string> lines(mChunk.size());
+        {
+            const profile::Scope scope("sbom.output");
+            parallelFor(mChunk.size(), [&](std::size_t i) {
+                if (!targets[i]) {
+                    return;
+                }
+                for (const auto& finding : findingsOf(i)) {
+                    json result = { { "component", mChunk[i].name }, { "version", targets[i]->version } };
+                    if (mChunk[i].purl) {
+                        result["purl"] = *mChunk[i].purl;
+                    } else {
+                        result["cpe"] = *mChunk[i].cpe;
+                    }
+                    result["source"] = targets[i]->source;
+                    result["cveId"] = finding.cveId.str();
+                    result["fixedVersion"] = finding.fixedVersion;
+                    result["nvd"] = mNvd.at(finding.cveId);
+                    lines[i] += result.dump();
+                    lines[i] += '\n';
+                }
+            });
+        }
+        for (std::size_t i = 0; i < mChunk.size(); ++i) {
+            if (targets[i]) {
+                ++mMatched;
+                if (!findingsOf(i).empty()) {
+                    ++mVulnerable;
+                }
+            }
+            mOutput << lines[i];
+        }
+        mOutput.flush();
+        mChunk.clear();
+        return static_cast<bool>(mOutput);
+    }
+
+    void logStats() const {
+        spdlog::debug("Scanned {} SBOM components of {}, {} of them debian packages, {} with fixed CVEs",
+                      mScanned,
+                      mCodename.value_or("an unknown release"),
+                      mMatched,
+                      mVulnerable);
+        mFetcher.logStats();
+    }
+
+private:
+    std::optional<Target> resolve(const Component& component) const {
+        if (component.purl) {
+            const auto package = parseDebianPurl(*component.purl);
+            if (!package || package->version.empty()) {
+                return std::nullopt;
+            }
+            auto version = package->sourceVersion.value_or(package->version);
+            if (package->source) {
+                return Target{ *package->source, std::move(version) };
+            }
+            // A fuzzy match is just a similar name, and most binary packages without CVEs have one
+            const auto matches = mTracker->resolvePackage(package->name, 1);
+            if (matches.empty() || matches.front().score <= debian::PackageResolver::FUZZY) {
+                return std::nullopt;
+            }
+            return Target{ std::string(matches.front().name), std::move(version) };
+        }
+        if (component.cpe) {
+            auto product = parseCpe(*component.cpe);
+            if (!product) {
+                return std::nullopt;
+            }
+            const auto matches = mTracker->resolvePackage(product->name, 1);
+            if (matches.empty() || matches.front().score < debian::PackageResolver::EXACT) {
+                return std::nullopt;
+            }
+            return Target{ std::move(product->name), std::move(product->version), true };
+        }
+        return std::nullopt;
+    }
+
+    std::vector<Finding> match(const Target& target) const {
+        std::vector<Finding> findings;
+        for (const auto& info : mTracker->getPackageInfo(target.source)) {
+            for (const auto& codename : info.codenames) {
+                if (!codename.fixedVersion) {
+                    continue;
+                }
+                // An upstream version predates every debian revision of it
+                const auto fixedVersion = target.upstream
+                                              ? utils::DebianVersion::parse(*codename.fixedVersion).upstream
+                                              : std::string_view(*codename.fixedVersion);
+                if (utils::compareVersions(target.version, fixedVersion) < 0) {
+                    findings.push_back(Finding{ info.cveId, *codename.fixedVersion });
+                }
+            }
+        }
+        return findings;
+    }
+
+    json toJson(const std::optional<nist::CveDescription>& description) const {
+        if (!description) {
+            return nullptr;
+        }
+        json nvd = *description;
+        nvd.erase("cveId");
+        nvd.erase("description");
+        if (mOptions.noCvss) {
+            nvd.erase("vectorString");
+        }
+        return nvd;
+    }
+
+    const std::filesystem::path& mSbomPath;
+    std::ostream& mOutput;
+    const Options& mOptions;
+    std::optional<std::string> mCodename;
+    std::optional<debian::DebianSecurityTracker> mTracker;
+    nist::Store mStore;
+    nist::Fetcher mFetcher;
+    std::vector<Component> mChunk;
+    /// NVD fields of the CVEs found so far, each is looked up once per scan
+    std::unordered_map<CveId, json> mNvd;
+    std::size_t mScanned = 0;
+    std::size_t mMatched = 0;
+    std::size_t mVulnerable = 0;
+};
+
+} // namespace
+
+bool sbom::parse(std::string_view document, const ComponentCallback& onComponent) {
+    ComponentParser parser(onComponent);
+    return json::sax_parse(document, &parser);
+}
+
+int sbom::run(const std::filesystem::path& sbomPath, std::ostream& output, const Options& options) {
+    std::optional<utils::MappedFile> document;
+    try {
+        document.emplace(sbomPath);
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to open {}: {}", sbomPath.string(), e.what());
+        return 1;
+    }
+
+    Scanner scanner(sbomPath, output, options);
+    bool scanned = false;
+    try {
+        scanned = parse(document->view(), [&scanner](Component&& component) {
+            return scanner.add(std::move(component));
+        }) && scanner.flush();
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to scan {}: {}", sbomPath.string(), e.what());
+        return 1;
+    }
+    scanner.logStats();
+
+    if (!output) {
+        spdlog::error("Failed to write SBOM scan results");
+        return 1;
+    }
+    return scanned ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+#include "cveinfo/scan.hpp"
+
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/serialization.hpp"
+#include "cveinfo/profile.hpp"
+#include "cveinfo/utils/DebianVersion.hpp"
+#include "cveinfo/utils/MappedFile.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+/// Installed binary packages built from one version of a source package
+struct InstalledSource {
+    std::string_view name;
+    std::string_view version;
+    std::vector<std::string_view> packages;
+};
+
+struct Finding {
+    CveId cveId;
+    std::string fixedVersion;
+};
+
+std::optional<std::string_view> fieldValue(std::string_view line, std::string_view field) {
+    if (line.size() <= field.size() || !line.starts_with(field) || line[field.size()] != ':') {
+        return std::nullopt;
+    }
+    auto value = line.substr(field.size() + 1);
+    value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+    return value;
+}
+
+/// Groups the installed packages of a dpkg status file by source package, viewing @p status.
+std::vector<InstalledSource> parseStatus(std::string_view status) {
+    std::map<std::pair<std::string_view, std::string_view>, std::vector<std::string_view>> sources;
+
+    std::string_view package;
+    std::string_view version;
+    std::string_view source;
+    bool installed = false;
+    const auto endStanza = [&] {
+        if (installed && !package.empty() && !version.empty()) {
+            // "Source: name (version)" is given when the source version differs from the binary one
+            auto sourceName = source.empty() ? package : source;
+            auto sourceVersion = version;
+            if (const auto paren = sourceName.find(" ("); paren != std::string_view::npos) {
+                const auto end = sourceName.find(')', paren);
+                sourceVersion = sourceName.substr(paren + 2, end - paren - 2);
+                sourceName = sourceName.substr(0, paren);
+            }
+            sources[{ sourceName, sourceVersion }].push_back(package);
+        }
+        package = version = source = {};
+        installed = false;
+    };
+
+    while (!status.empty()) {
+        const auto newline = status.find('\n');
+        auto line = status.substr(0, newline);
+        status.remove_prefix(newline == std::string_view::npos ? status.size() : newline + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        if (line.empty()) {
+            endStanza();
+        } else if (const auto value = fieldValue(line, "Package")) {
+            package = *value;
+        } else if (const auto value = fieldValue(line, "Version")) {
+            version = *value;
+        } else if (const auto value = fieldValue(line, "Source")) {
+            source = *value;
+        } else if (const auto value = fieldValue(line, "Status")) {
+            installed = value->ends_with(" installed");
+        }
+    }
+    endStanza();
+
+    std::vector<InstalledSource> installedSources;
+    installedSources.reserve(sources.size());
+    for (auto& [key, packages] : sources) {
+        installedSources.push_back(InstalledSource{ key.first, key.second, std::move(packages) });
+    }
+    return installedSources;
+}
+
+std::optional<std::string> detectCodename(const std::filesystem::path& statusPath) {
+    // <root>/var/lib/dpkg/status, anywhere else the root (and the release) is unknown
+    auto root = std::filesystem::absolute(statusPath).lexically_normal();
+    for (const auto* component : { "status", "dpkg", "lib", "var" }) {
+        if (root.filename() != component) {
+            return std::nullopt;
+        }
+        root = root.parent_path();
+    }
+    for (const auto& path : { root / "etc/os-release", root / "usr/lib/os-release" }) {
+        std::ifstream input(path);
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.rfind("VERSION_CODENAME=", 0) != 0) {
+                continue;
+            }
+            auto codename = line.substr(line.find('=') + 1);
+            codename.erase(std::remove(std::begin(codename), std::end(codename), '"'), std::end(codename));
+            if (!codename.empty()) {
+                return codename;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<Finding> match(const debian::DebianSecurityTracker& tracker, const InstalledSource& source) {
+    std::vector<Finding> findings;
+    for (const auto& info : tracker.getPackageInfo(std::string(source.name))) {
+        for (const auto& codename : info.codenames) {
+            if (codename.fixedVersion && utils::compareVersions(source.version, *codename.fixedVersion) < 0) {
+                findings.push_back(Finding{ info.cveId, *codename.fixedVersion });
+            }
+        }
+    }
+    return findings;
+}
+
+} // namespace
+
+int scan::run(const std::filesystem::path& statusPath, std::ostream& output, const Options& options) {
+    const auto codename = options.codename ? options.codename : detectCodename(statusPath);
+    if (!codename) {
+        spdlog::error("Failed to detect the debian release of {}, please specify its codename",
+                      statusPath.string());
+        return 1;
+    }
+
+    std::optional<utils::MappedFile> status;
+    try {
+        status.emplace(statusPath);
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to open {}: {}", statusPath.string(), e.what());
+        return 1;
+    }
+    const auto sources = [&] {
+        const profile::Scope scope("scan.status");
+        return parseStatus(status->view());
+    }();
+    profile::add(profile::Counter::PACKAGES_SCANNED, sources.size());
+    const debian::DebianSecurityTracker tracker(codename, options.trackerFreshness);
+
+    // Source packages are independent, the workers just pick the next one until all are matched
+    std::vector<std::vector<Finding>> findings(sources.size());
+    std::atomic<std::size_t> next = 0;
+    const auto worker = [&] {
+        const profile::Scope scope("scan.match");
+        for (std::size_t i; (i = next++) < sources.size();) {
+            findings[i] = match(tracker, sources[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    const auto threads =
+        std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, sources.size() / 16 + 1);
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    const profile::Scope scope("scan.output");
+    nist::Store store(nist::Store::defaultPath(), options.cacheSize);
+    std::size_t vulnerable = 0;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        for (const auto& finding : findings[i]) {
+            json result = { { "source", sources[i].name },
+                            { "version", sources[i].version },
+                            { "packages", sources[i].packages },
+                            { "cveId", finding.cveId.str() },
+                            { "fixedVersion", finding.fixedVersion } };
+            if (const auto entry = store.get(finding.cveId)) {
+                json nvd = entry->description;
+                nvd.erase("cveId");
+                nvd.erase("description");
+                if (options.noCvss) {
+                    nvd.erase("vectorString");
+                }
+                result["nvd"] = std::move(nvd);
+            } else {
+                result["nvd"] = nullptr;
+            }
+            output << result.dump() << '\n';
+        }
+        if (!findings[i].empty()) {
+            ++vulnerable;
+        }
+    }
+    output.flush();
+    spdlog::debug("Scanned {} source packages of {}, {} of them with fixed CVEs",
+                  sources.size(),
+                  *codename,
+                  vulnerable);
+
+    if (!output) {
+        spdlog::error("Failed to write scan results");
+        return 1;
+    }
+    return 0;
+}
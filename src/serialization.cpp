@@ -0,0 +1,61 @@
+#include "cveinfo/cve/serialization.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+template <typename T>
+void getOptional(const json& j, const char* key, std::optional<T>& value) {
+    const auto it = j.find(key);
+    value = it != std::end(j) && !it->is_null() ? std::optional<T>(it->template get<T>()) : std::nullopt;
+}
+
+template <typename T>
+void setOptional(json& j, const char* key, const std::optional<T>& value) {
+    if (value) {
+        j[key] = *value;
+    }
+}
+
+} // namespace
+
+void nist::to_json(json& j, const CveDescription& description) {
+    j = json::object();
+    j["cveId"] = description.cveId.str();
+    setOptional(j, "description", description.description);
+    setOptional(j, "vectorString", description.vectorString);
+    setOptional(j, "severity", description.severity);
+    if (description.score) {
+        // CVSS scores have a single decimal place, don't leak the float rounding error into the output
+        j["score"] = std::round(static_cast<double>(*description.score) * 10) / 10;
+    }
+}
+
+void nist::from_json(const json& j, CveDescription& description) {
+    const auto cveId = j.at("cveId").get<std::string>();
+    description.cveId = CveId::parse(cveId).value_or(CveId());
+    if (description.cveId.empty()) {
+        throw std::invalid_argument("malformed CVE ID " + cveId);
+    }
+    getOptional(j, "description", description.description);
+    getOptional(j, "vectorString", description.vectorString);
+    getOptional(j, "severity", description.severity);
+    getOptional(j, "score", description.score);
+}
+
+void debian::to_json(json& j, const CodenameInfo& info) {
+    j = json::object();
+    j["name"] = info.name;
+    setOptional(j, "status", info.status);
+    setOptional(j, "fixedVersion", info.fixedVersion);
+}
+
+void debian::to_json(json& j, const TrackerInfo& info) {
+    j = json::object();
+    j["package"] = info.packageName;
+    j["codenames"] = info.codenames;
+}
@@ -0,0 +1,209 @@
+#include "cveinfo/server.hpp"
+
+#include "cveinfo/Context.hpp"
+#include "cveinfo/batch.hpp"
+#include "cveinfo/profile.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+constexpr std::size_t MAX_LINE_LENGTH = 4096;
+constexpr std::string_view METRICS_COMMAND = "metrics";
+
+std::atomic<int> gListenFd = -1;
+std::atomic<bool> gStopRequested = false;
+
+extern "C" void requestStop(int) {
+    gStopRequested = true;
+    // Wakes the accept loop up
+    if (const int fd = gListenFd.load(); fd >= 0) {
+        shutdown(fd, SHUT_RDWR);
+    }
+}
+
+bool sendAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const auto n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+class Server {
+public:
+    explicit Server(const Options& options)
+        : mContext(options) {}
+
+    int run(const std::filesystem::path& socketPath);
+
+private:
+    void serve(int fd);
+    std::string answer(const std::string& line);
+
+    Context mContext;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::unordered_set<int> mConnections;
+};
+
+int Server::run(const std::filesystem::path& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.native().size() >= sizeof(address.sun_path)) {
+        spdlog::error("Socket path too long: {}", socketPath.string());
+        return 1;
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+
+    const int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        spdlog::error("Failed to create socket: {}", std::strerror(errno));
+        return 1;
+    }
+    // A socket left behind by a server that didn't stop cleanly
+    if (std::filesystem::is_socket(socketPath)) {
+        std::filesystem::remove(socketPath);
+    }
+    if (bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, SOMAXCONN) != 0) {
+        spdlog::error("Failed to listen on {}: {}", socketPath.string(), std::strerror(errno));
+        ::close(listenFd);
+        return 1;
+    }
+
+    gListenFd = listenFd;
+    struct sigaction action{};
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    spdlog::info("Listening on {}", socketPath.string());
+
+    int result = 0;
+    while (!gStopRequested) {
+        const int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (gStopRequested || errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            spdlog::error("Failed to accept connection: {}", std::strerror(errno));
+            result = 1;
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            mConnections.insert(fd);
+        }
+        std::thread([this, fd] { serve(fd); }).detach();
+    }
+
+    // Connections are shut down rather than closed, their threads close them once they're done
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        for (const int fd : mConnections) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this] { return mConnections.empty(); });
+    }
+
+    gListenFd = -1;
+    ::close(listenFd);
+    std::error_code ec;
+    std::filesystem::remove(socketPath, ec);
+    spdlog::info("Server stopped");
+    return result;
+}
+
+void Server::serve(int fd) {
+    std::string buffer;
+    char chunk[4096];
+    while (true) {
+        const auto n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(n));
+
+        std::size_t start = 0;
+        bool connected = true;
+        for (std::size_t end; connected && (end = buffer.find('\n', start)) != std::string::npos;
+             start = end + 1) {
+            const auto response = answer(buffer.substr(start, end - start));
+            connected = response.empty() || sendAll(fd, response);
+        }
+        buffer.erase(0, start);
+        if (!connected) {
+            break;
+        }
+        if (buffer.size() > MAX_LINE_LENGTH) {
+            sendAll(fd, json{ { "error", "line too long" } }.dump() + '\n');
+            break;
+        }
+    }
+
+    // Notified with the lock held: once it's released, run() may return and destroy the server
+    std::lock_guard<std::mutex> guard(mMutex);
+    mConnections.erase(fd);
+    ::close(fd);
+    mCondition.notify_all();
+}
+
+std::string Server::answer(const std::string& line) {
+    try {
+        auto query = batch::parseQuery(line);
+        if (!query) {
+            return {};
+        }
+        if (query->cveId == METRICS_COMMAND) {
+            return profile::prometheus();
+        }
+        return mContext.query(std::move(*query)).get().dump() + '\n';
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to answer {}: {}", line, e.what());
+        return json{ { "error", e.what() } }.dump() + '\n';
+    }
+}
+
+} // namespace
+
+int server::run(const std::filesystem::path& socketPath, const Options& options) {
+    try {
+        return Server(options).run(socketPath);
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to start server: {}", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,368 @@
+#include "cveinfo/snapshot.hpp"
+
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/profile.hpp"
+#include "cveinfo/utils/MappedFile.hpp"
+#include "cveinfo/utils/utils.hpp"
+
+#include <spdlog/fmt/chrono.h>
+#include <spdlog/spdlog.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string_view>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace cveinfo;
+using debian::DebianSecurityTracker;
+
+namespace {
+
+constexpr char MAGIC[8] = { 'C', 'V', 'E', 'S', 'N', 'A', 'P', '\0' };
+constexpr std::uint32_t VERSION = 1;
+
+// Exported once for many imports, decompression speed hardly depends on the level
+constexpr int COMPRESSION_LEVEL = 12;
+constexpr std::size_t CHUNK_SIZE = 1024 * 1024;
+
+constexpr std::string_view NVD_DATA = "nvd.store";
+constexpr std::string_view NVD_INDEX = "nvd.store.idx";
+constexpr auto IMPORT_SUFFIX = ".import";
+
+struct BundleHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t fileCount;
+    std::int64_t created;
+};
+
+/// Followed by the name and the zstd frame of the file
+struct FileHeader {
+    std::uint32_t checksum;
+    std::uint16_t nameLength;
+    std::uint16_t reserved;
+    std::uint64_t size;
+    std::uint64_t compressedSize;
+    /// Modification time in nanoseconds since the epoch
+    std::int64_t mtime;
+};
+
+struct BundledFile {
+    std::string name;
+    std::uint64_t size;
+    std::int64_t mtime;
+    std::string_view frame;
+};
+
+struct Bundle {
+    std::chrono::system_clock::time_point created;
+    std::vector<BundledFile> files;
+};
+
+/// Checksum of the header and name of a file, its content is covered by the checksum of its zstd frame
+std::uint32_t checksum(FileHeader header, std::string_view name) {
+    header.checksum = 0;
+    std::uint32_t hash = 0x811c9dc5;
+    const std::string_view fields(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto data : { fields, name }) {
+        for (const char c : data) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x01000193;
+        }
+    }
+    return hash;
+}
+
+/// Whether @p name is the debian tracker database, its metadata or one of its indexes
+bool isTrackerFile(std::string_view name) {
+    const auto database = DebianSecurityTracker::databasePath();
+    const auto databaseName = database.filename().string();
+    return name == databaseName || name == databaseName + ".meta" ||
+           (name.starts_with(database.stem().string()) && name.ends_with(".idx") &&
+            name.find('/') == std::string_view::npos);
+}
+
+std::int64_t modificationTime(const std::filesystem::path& path) {
+    struct stat buf;
+    if (stat(path.c_str(), &buf) != 0) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, path };
+    }
+    return std::int64_t(buf.st_mtim.tv_sec) * 1'000'000'000 + buf.st_mtim.tv_nsec;
+}
+
+void setModificationTime(const std::filesystem::path& path, std::int64_t mtime) {
+    const timespec times[2] = { { 0, UTIME_NOW }, { mtime / 1'000'000'000, mtime % 1'000'000'000 } };
+    if (utimensat(AT_FDCWD, path.c_str(), times, 0) != 0) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, path };
+    }
+}
+
+void checkZstd(std::size_t result, const std::string& subject) {
+    if (ZSTD_isError(result)) {
+        throw std::runtime_error(subject + ": " + ZSTD_getErrorName(result));
+    }
+}
+
+/// Writes @p path of @p size bytes to @p output as one zstd frame, returns the size of the frame
+std::uint64_t compressFile(ZSTD_CCtx* context,
+                           const std::filesystem::path& path,
+                           std::uint64_t size,
+                           std::ostream& output) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, path };
+    }
+    checkZstd(ZSTD_CCtx_reset(context, ZSTD_reset_session_only), path);
+    // The content size in the frame header lets a short file be detected on import
+    checkZstd(ZSTD_CCtx_setPledgedSrcSize(context, size), path);
+
+    std::string in(CHUNK_SIZE, '\0');
+    std::string out(ZSTD_CStreamOutSize(), '\0');
+    std::uint64_t written = 0;
+    bool last = false;
+    while (!last) {
+        input.read(in.data(), static_cast<std::streamsize>(in.size()));
+        const auto read = static_cast<std::size_t>(input.gcount());
+        last = read < in.size();
+        ZSTD_inBuffer inBuffer{ in.data(), read, 0 };
+        bool flushed = false;
+        while (!flushed) {
+            ZSTD_outBuffer outBuffer{ out.data(), out.size(), 0 };
+            const auto remaining =
+                ZSTD_compressStream2(context, &outBuffer, &inBuffer, last ? ZSTD_e_end : ZSTD_e_continue);
+            checkZstd(remaining, path);
+            output.write(out.data(), static_cast<std::streamsize>(outBuffer.pos));
+            written += outBuffer.pos;
+            flushed = last ? remaining == 0 : inBuffer.pos == inBuffer.size;
+        }
+    }
+    if (input.bad()) {
+        throw std::runtime_error("failed to read " + path.string());
+    }
+    return written;
+}
+
+void decompressFile(const BundledFile& file, const std::filesystem::path& target) {
+    const profile::Scope scope("snapshot.decompress");
+    const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+    std::ofstream output(target, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::system_error{ std::error_code{ errno, std::system_category() }, target };
+    }
+    std::string out(ZSTD_DStreamOutSize(), '\0');
+    ZSTD_inBuffer in{ file.frame.data(), file.frame.size(), 0 };
+    std::uint64_t written = 0;
+    while (true) {
+        ZSTD_outBuffer outBuffer{ out.data(), out.size(), 0 };
+        // Verifies the content checksum at the end of the frame
+        const auto result = ZSTD_decompressStream(context.get(), &outBuffer, &in);
+        checkZstd(result, file.name);
+        output.write(out.data(), static_cast<std::streamsize>(outBuffer.pos));
+        written += outBuffer.pos;
+        if (result == 0) {
+            break;
+        }
+        if (in.pos == in.size && outBuffer.pos < outBuffer.size) {
+            throw std::runtime_error(file.name + ": truncated");
+        }
+    }
+    if (written != file.size) {
+        throw std::runtime_error(fmt::format("{}: {} bytes instead of {}", file.name, written, file.size));
+    }
+    output.close();
+    if (!output) {
+        throw std::runtime_error("failed to write " + target.string());
+    }
+    setModificationTime(target, file.mtime);
+}
+
+Bundle readBundle(std::string_view data) {
+    BundleHeader header;
+    if (data.size() < sizeof(header)) {
+        throw std::runtime_error("not a cveinfo snapshot");
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("not a cveinfo snapshot");
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error(fmt::format("unsupported snapshot version {}", header.version));
+    }
+
+    Bundle bundle{ std::chrono::system_clock::time_point(std::chrono::seconds(header.created)), {} };
+    std::size_t pos = sizeof(header);
+    for (std::uint32_t i = 0; i < header.fileCount; ++i) {
+        FileHeader fileHeader;
+        if (data.size() - pos < sizeof(fileHeader)) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        std::memcpy(&fileHeader, data.data() + pos, sizeof(fileHeader));
+        pos += sizeof(fileHeader);
+        if (data.size() - pos < fileHeader.nameLength) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        const auto name = data.substr(pos, fileHeader.nameLength);
+        pos += name.size();
+        if (checksum(fileHeader, name) != fileHeader.checksum) {
+            throw std::runtime_error("corrupted snapshot");
+        }
+        if (data.size() - pos < fileHeader.compressedSize) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        // Nothing but the databases may be written by an import
+        if (name != NVD_DATA && name != NVD_INDEX && !isTrackerFile(name)) {
+            throw std::runtime_error(fmt::format("unexpected file {} in snapshot", name));
+        }
+        const auto frame = data.substr(pos, static_cast<std::size_t>(fileHeader.compressedSize));
+        pos += frame.size();
+        bundle.files.push_back(BundledFile{ std::string(name), fileHeader.size, fileHeader.mtime, frame });
+    }
+    return bundle;
+}
+
+} // namespace
+
+int snapshot::exportTo(const std::filesystem::path& path, const Options& options) {
+    const profile::Scope scope("snapshot.export");
+    const auto directory = utils::createCveInfoDir();
+    const auto staging = directory / "snapshot.export";
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    try {
+        std::filesystem::create_directories(staging);
+        {
+            nist::Store store(nist::Store::defaultPath(), options.cacheSize);
+            store.exportTo(staging / NVD_DATA, staging / NVD_INDEX);
+        }
+
+        // Holds off the tracker downloads until the database and its indexes are bundled
+        const auto lease = DebianSecurityTracker::lockDatabase();
+        std::vector<std::pair<std::string, std::filesystem::path>> files;
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            const auto name = entry.path().filename().string();
+            if (entry.is_regular_file() && isTrackerFile(name)) {
+                files.emplace_back(name, entry.path());
+            }
+        }
+        if (!std::filesystem::exists(DebianSecurityTracker::databasePath())) {
+            throw std::runtime_error("no debian security tracker database, run a lookup first");
+        }
+        std::sort(std::begin(files), std::end(files));
+        files.emplace_back(NVD_DATA, staging / NVD_DATA);
+        files.emplace_back(NVD_INDEX, staging / NVD_INDEX);
+
+        const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(), ZSTD_freeCCtx);
+        checkZstd(ZSTD_CCtx_setParameter(context.get(), ZSTD_c_compressionLevel, COMPRESSION_LEVEL), "zstd");
+        checkZstd(ZSTD_CCtx_setParameter(context.get(), ZSTD_c_checksumFlag, 1), "zstd");
+        // Fails without multithreading support in zstd, which then just compresses on this thread
+        ZSTD_CCtx_setParameter(
+            context.get(), ZSTD_c_nbWorkers, static_cast<int>(std::thread::hardware_concurrency()));
+
+        std::ofstream output(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            throw std::system_error{ std::error_code{ errno, std::system_category() }, tmpPath };
+        }
+        BundleHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.fileCount = static_cast<std::uint32_t>(files.size());
+        header.created = std::chrono::duration_cast<std::chrono::seconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (const auto& [name, source] : files) {
+            FileHeader fileHeader{};
+            fileHeader.nameLength = static_cast<std::uint16_t>(name.size());
+            fileHeader.size = std::filesystem::file_size(source);
+            fileHeader.mtime = modificationTime(source);
+            // The header is written again once the size of the frame is known
+            const auto start = output.tellp();
+            output.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+            output.write(name.data(), static_cast<std::streamsize>(name.size()));
+            fileHeader.compressedSize = compressFile(context.get(), source, fileHeader.size, output);
+            fileHeader.checksum = checksum(fileHeader, name);
+            const auto end = output.tellp();
+            output.seekp(start);
+            output.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+            output.seekp(end);
+            spdlog::debug(
+                "Bundled {}: {} bytes, {} compressed", name, fileHeader.size, fileHeader.compressedSize);
+        }
+        output.close();
+        if (!output) {
+            throw std::runtime_error("failed to write " + tmpPath.string());
+        }
+        std::filesystem::rename(tmpPath, path);
+        std::filesystem::remove_all(staging);
+        spdlog::info("Exported {} files to {} ({} bytes)",
+                     files.size(),
+                     path.string(),
+                     std::filesystem::file_size(path));
+        return 0;
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to export snapshot: {}", e.what());
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
+        std::filesystem::remove_all(staging, ec);
+        return 1;
+    }
+}
+
+int snapshot::importFrom(const std::filesystem::path& path, const Options& options) {
+    const profile::Scope scope("snapshot.import");
+    const auto directory = utils::createCveInfoDir();
+    std::vector<std::filesystem::path> decompressed;
+    try {
+        const utils::MappedFile mapped(path);
+        const auto bundle = readBundle(mapped.view());
+
+        // The files are independent frames, decompressed next to their destination concurrently
+        {
+            std::vector<std::future<void>> jobs;
+            for (const auto& file : bundle.files) {
+                decompressed.push_back(directory / (file.name + IMPORT_SUFFIX));
+                jobs.push_back(std::async(std::launch::async, [&file, target = decompressed.back()] {
+                    decompressFile(file, target);
+                }));
+            }
+            for (auto& job : jobs) {
+                job.get();
+            }
+        }
+
+        const auto target = [&directory](std::string_view name) {
+            return directory / (std::string(name) + IMPORT_SUFFIX);
+        };
+        {
+            // Readers keep the database they opened, the files are replaced by renaming
+            const auto lease = DebianSecurityTracker::lockDatabase();
+            for (const auto& file : bundle.files) {
+                if (isTrackerFile(file.name)) {
+                    std::filesystem::rename(target(file.name), directory / file.name);
+                }
+            }
+        }
+        if (std::filesystem::exists(target(NVD_DATA))) {
+            nist::Store store(nist::Store::defaultPath(), options.cacheSize);
+            store.importFrom(target(NVD_DATA), target(NVD_INDEX));
+        }
+        spdlog::info("Imported {} files of the snapshot from {}", bundle.files.size(), bundle.created);
+        return 0;
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to import snapshot {}: {}", path.string(), e.what());
+        std::error_code ec;
+        for (const auto& file : decompressed) {
+            std::filesystem::remove(file, ec);
+        }
+        return 1;
+    }
+}
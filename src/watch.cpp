@@ -0,0 +1,113 @@
+#include "cveinfo/watch.hpp"
+
+#include "cveinfo/changes.hpp"
+#include "cveinfo/cve/DebianSecurityTracker.hpp"
+#include "cveinfo/cve/NistFetcher.hpp"
+#include "cveinfo/cve/NistStore.hpp"
+#include "cveinfo/cve/nist.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <future>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace cveinfo;
+using nlohmann::json;
+
+namespace {
+
+std::optional<std::set<std::string>> readWatchlist(const std::filesystem::path& path) {
+    std::ifstream input(path);
+    if (!input) {
+        return std::nullopt;
+    }
+    std::set<std::string> packages;
+    std::string line;
+    while (std::getline(input, line)) {
+        line = line.substr(0, line.find('#'));
+        const auto begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos) {
+            continue;
+        }
+        packages.insert(line.substr(begin, line.find_last_not_of(" \t\r") - begin + 1));
+    }
+    return packages;
+}
+
+} // namespace
+
+int watch::run(const std::filesystem::path& watchlist,
+               std::chrono::seconds interval,
+               std::ostream& output,
+               const Options& options) {
+    const auto packages = readWatchlist(watchlist);
+    if (!packages) {
+        spdlog::error("Failed to open {}", watchlist.string());
+        return 1;
+    }
+    if (packages->empty()) {
+        spdlog::error("No packages to watch in {}", watchlist.string());
+        return 1;
+    }
+
+    // Follows the feed from before the first refresh, so its changes are reported too
+    changes::Follower follower;
+    nist::Store store(nist::Store::defaultPath(), options.cacheSize);
+    nist::Fetcher fetcher(options.apiKey, options.jobs);
+    spdlog::info("Watching {} packages, checking for changes every {}s", packages->size(), interval.count());
+    for (;;) {
+        // Score changes are matched through the CVEs of the watched packages
+        std::unordered_map<CveId, std::vector<std::string>> cvePackages;
+        {
+            using debian::DebianSecurityTracker;
+            const DebianSecurityTracker tracker(
+                options.codename, options.trackerFreshness, DebianSecurityTracker::RefreshMode::FOREGROUND);
+            for (const auto& package : *packages) {
+                for (const auto& info : tracker.getPackageInfo(package)) {
+                    cvePackages[info.cveId].push_back(package);
+                }
+            }
+        }
+        // Expired records are fetched again right away, stale ones are revalidated in the background
+        std::vector<std::future<std::optional<nist::CveDescription>>> lookups;
+        lookups.reserve(cvePackages.size());
+        for (const auto& entry : cvePackages) {
+            lookups.push_back(
+                nist::getCveDescriptionAsync(entry.first, fetcher, store, options.nvdFreshness));
+        }
+        for (auto& lookup : lookups) {
+            lookup.get();
+        }
+
+        for (auto& change : follower.poll()) {
+            if (const auto package = change.find("package"); package != std::end(change)) {
+                if (!package->is_string() || !packages->contains(package->get<std::string>())) {
+                    continue;
+                }
+            } else {
+                const auto cveId = CveId::parse(change.value("cveId", ""));
+                const auto cve = cveId ? cvePackages.find(*cveId) : std::end(cvePackages);
+                if (cve == std::end(cvePackages)) {
+                    continue;
+                }
+                change["packages"] = cve->second;
+            }
+            if (options.codename && change.value("codename", *options.codename) != *options.codename) {
+                continue;
+            }
+            output << change.dump() << '\n';
+        }
+        output.flush();
+        if (!output) {
+            spdlog::error("Failed to write changes");
+            return 1;
+        }
+        std::this_thread::sleep_for(interval);
+    }
+}
@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+"""Drives cveinfo under load against tools/mock_server.py and reports throughput, tail latency and retries.
+
+Everything runs locally: the mock server stands in for NVD and the debian security tracker and cveinfo
+gets a temporary cache directory, so no run depends on or affects the real services or caches.
+
+Scenarios:
+    lookup  one cveinfo process per query, --concurrency of them at a time
+    batch   all queries through a single `cveinfo --batch -`, with --concurrency NVD requests in flight
+    serve   queries sent to `cveinfo --serve` by --concurrency clients
+
+    tools/load_harness.py --cveinfo _build/bin/cveinfo --scenario batch --queries 500 \\
+                          --concurrency 16 --mock-args="--latency 150 --jitter 100 --forbidden-rate 0.05"
+"""
+
+import argparse
+import json
+import os
+import re
+import shlex
+import socket
+import statistics
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import urllib.request
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import mock_server  # noqa: E402
+
+# Logged by cveinfo after bulk NVD fetches, see Fetcher::logStats()
+FETCHER_STATS = re.compile(r"NVD: (\d+) requests in .* (\d+) forbidden, (\d+) retries, (\d+) failed")
+
+
+class MockProcess:
+    def __init__(self, arguments):
+        script = Path(__file__).resolve().parent / "mock_server.py"
+        self.process = subprocess.Popen([sys.executable, str(script), *arguments],
+                                        stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+        line = self.process.stdout.readline()
+        if not line.startswith("Listening on "):
+            self.process.kill()
+            raise RuntimeError("mock server failed to start")
+        self.url = line.split()[-1]
+
+    def stats(self):
+        with urllib.request.urlopen(self.url + mock_server.STATS_PATH) as response:
+            return json.load(response)
+
+    def stop(self):
+        self.process.terminate()
+        self.process.wait()
+
+
+def percentile(values, fraction):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[min(int(fraction * len(ordered)), len(ordered) - 1)]
+
+
+def make_queries(count, distinct, cves):
+    """`count` CVE IDs cycling through `distinct` of the tracker's, the rest of the lookups hit the cache."""
+    step = max(cves // max(distinct, 1), 1)
+    return [mock_server.cve_id_at((i % distinct) * step % cves) for i in range(count)]
+
+
+def run_lookup(args, env, queries):
+    def lookup(cve_id):
+        started = time.monotonic()
+        result = subprocess.run([args.cveinfo, *args.cveinfo_args, cve_id], env=env,
+                                stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+        return time.monotonic() - started, result.returncode == 0, result.stderr
+
+    with ThreadPoolExecutor(args.concurrency) as pool:
+        results = list(pool.map(lookup, queries))
+    return [r[0] for r in results], sum(not r[1] for r in results), "".join(r[2] for r in results)
+
+
+def run_batch(args, env, queries):
+    started = time.monotonic()
+    process = subprocess.Popen([args.cveinfo, *args.cveinfo_args, "-j", str(args.concurrency),
+                                "--batch", "-"],
+                               env=env, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                               stderr=subprocess.PIPE, text=True)
+    stderr = []
+    reader = threading.Thread(target=lambda: stderr.extend(process.stderr))
+    reader.start()
+    process.stdin.write("".join(f"{cve_id}\n" for cve_id in queries))
+    process.stdin.close()
+
+    # Results come out in input order, each one is timed from the start of the batch
+    latencies = []
+    failures = 0
+    for line in process.stdout:
+        latencies.append(time.monotonic() - started)
+        if json.loads(line).get("nvd") is None:
+            failures += 1
+    process.wait()
+    reader.join()
+    failures += len(queries) - len(latencies)
+    return latencies, failures, "".join(stderr)
+
+
+def run_serve(args, env, queries):
+    socket_path = os.path.join(env["XDG_CACHE_HOME"], "cveinfo.sock")
+    process = subprocess.Popen([args.cveinfo, *args.cveinfo_args, "-j", str(args.concurrency),
+                                "--serve", socket_path],
+                               env=env, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    deadline = time.monotonic() + args.timeout
+    while not os.path.exists(socket_path):
+        if process.poll() is not None or time.monotonic() > deadline:
+            process.kill()
+            raise RuntimeError("cveinfo --serve failed to start")
+        time.sleep(0.05)
+
+    def client(part):
+        latencies, failures = [], 0
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as connection:
+            connection.connect(socket_path)
+            lines = connection.makefile("rw")
+            for cve_id in part:
+                started = time.monotonic()
+                lines.write(f"{cve_id}\n")
+                lines.flush()
+                response = lines.readline()
+                latencies.append(time.monotonic() - started)
+                result = json.loads(response) if response else {}
+                if "error" in result or result.get("nvd") is None:
+                    failures += 1
+        return latencies, failures
+
+    parts = [queries[i::args.concurrency] for i in range(args.concurrency)]
+    with ThreadPoolExecutor(args.concurrency) as pool:
+        results = list(pool.map(client, parts))
+    process.terminate()
+    _, stderr = process.communicate()
+    return [l for r in results for l in r[0]], sum(r[1] for r in results), stderr
+
+
+SCENARIOS = {"lookup": run_lookup, "batch": run_batch, "serve": run_serve}
+
+
+def parse_args(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--cveinfo", required=True, help="cveinfo binary to drive")
+    parser.add_argument("--scenario", choices=sorted(SCENARIOS), default="batch")
+    parser.add_argument("--queries", type=int, default=200)
+    parser.add_argument("--distinct", type=int, default=0,
+                        help="distinct CVEs queried (default: every query a different one)")
+    parser.add_argument("--concurrency", type=int, default=8)
+    parser.add_argument("--rate-limit", type=int, default=1000000,
+                        help="NVD requests cveinfo may send per 30 s (default: effectively unlimited)")
+    parser.add_argument("--tracker-packages", type=int, default=500)
+    parser.add_argument("--mock-args", default="",
+                        help="extra mock_server.py arguments, e.g. '--latency 100'")
+    parser.add_argument("--cveinfo-args", default="", help="extra cveinfo arguments, e.g. '--nvd-max-age 1m'")
+    parser.add_argument("--warm", action="store_true", help="download the tracker before measuring")
+    parser.add_argument("--timeout", type=float, default=30, help="seconds to wait for cveinfo --serve")
+    parser.add_argument("--json", action="store_true", help="print the report as JSON")
+    args = parser.parse_args(argv)
+    args.cveinfo = str(Path(args.cveinfo).resolve())
+    args.cveinfo_args = shlex.split(args.cveinfo_args)
+    args.distinct = args.distinct or args.queries
+    return args
+
+
+def main(argv=None):
+    args = parse_args(argv)
+    mock = MockProcess(["--tracker-packages", str(args.tracker_packages), *shlex.split(args.mock_args)])
+    try:
+        with tempfile.TemporaryDirectory(prefix="cveinfo-load-") as cache:
+            env = dict(os.environ,
+                       XDG_CACHE_HOME=cache,
+                       CVEINFO_NVD_URL=mock.url + mock_server.NVD_PATH,
+                       CVEINFO_TRACKER_URL=mock.url + mock_server.TRACKER_PATH,
+                       CVEINFO_NVD_RATE_LIMIT=str(args.rate_limit))
+            cves = max(args.tracker_packages * 10 * 3 // 4, 1)
+            queries = make_queries(args.queries, args.distinct, cves)
+            if args.warm:
+                subprocess.run([args.cveinfo, "--package", "package0"], env=env,
+                               stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+            before = mock.stats()
+            started = time.monotonic()
+            latencies, failures, stderr = SCENARIOS[args.scenario](args, env, queries)
+            elapsed = time.monotonic() - started
+            after = mock.stats()
+    finally:
+        mock.stop()
+
+    server = {name: after[name] - before.get(name, 0) for name in after}
+    fetcher = {"requests": 0, "forbidden": 0, "retries": 0, "failed": 0}
+    for match in FETCHER_STATS.finditer(stderr):
+        for name, value in zip(fetcher, match.groups()):
+            fetcher[name] += int(value)
+
+    report = {
+        "scenario": args.scenario,
+        "queries": len(queries),
+        "failures": failures,
+        "elapsedSeconds": round(elapsed, 3),
+        "queriesPerSecond": round(len(queries) / elapsed, 2) if elapsed > 0 else 0,
+        "latencyMs": {
+            "mean": round(statistics.fmean(latencies) * 1000, 2) if latencies else 0,
+            "p50": round(percentile(latencies, 0.50) * 1000, 2),
+            "p90": round(percentile(latencies, 0.90) * 1000, 2),
+            "p99": round(percentile(latencies, 0.99) * 1000, 2),
+            "max": round(max(latencies, default=0) * 1000, 2),
+        },
+        "server": server,
+        "fetcher": fetcher,
+    }
+    if args.json:
+        print(json.dumps(report, indent=2))
+    else:
+        latency = report["latencyMs"]
+        print(f"{args.scenario}: {len(queries)} queries in {elapsed:.2f}s "
+              f"({report['queriesPerSecond']} queries/s), {failures} failed")
+        print(f"latency (ms): mean {latency['mean']}, p50 {latency['p50']}, p90 {latency['p90']}, "
+              f"p99 {latency['p99']}, max {latency['max']}")
+        print(f"mock server: {server['nvd']} NVD and {server['tracker']} tracker requests, "
+              f"{server['forbidden']} forbidden, {server['errors']} errors, {server['retries']} retried, "
+              f"{server['notModified']} not modified, {server['bytes'] / 1024:.0f} KiB sent")
+        if fetcher["requests"]:
+            print(f"cveinfo fetcher: {fetcher['requests']} requests, {fetcher['forbidden']} forbidden, "
+                  f"{fetcher['retries']} retries, {fetcher['failed']} failed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+"""Local stand-in for the NVD CVE API and the debian security tracker.
+
+Serves generated (or given) fixture data with configurable latency, bandwidth, 403 rate limiting, 5xx
+errors and ETag/Last-Modified revalidation, so the fetch paths of cveinfo can be exercised without the
+real services:
+
+    tools/mock_server.py --port 8080 --latency 200 --forbidden-rate 0.1 &
+    cveinfo --nvd-url http://127.0.0.1:8080/rest/json/cves/2.0 \\
+            --tracker-url http://127.0.0.1:8080/tracker/data/json CVE-2000-1000
+
+Routes:
+    GET /rest/json/cves/2.0?cveId=<id>                      one CVE
+    GET /rest/json/cves/2.0?resultsPerPage=<n>&startIndex=<i>  a page of --total-results CVEs, also
+                                                            for cpeName and virtualMatchString queries
+    GET /tracker/data/json                                  the tracker dump
+    GET /stats                                              request counters as JSON
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import email.utils
+import gzip
+import hashlib
+import json
+import random
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from pathlib import Path
+from urllib.parse import parse_qs, urlparse
+
+NVD_PATH = "/rest/json/cves/2.0"
+TRACKER_PATH = "/tracker/data/json"
+STATS_PATH = "/stats"
+
+CODENAMES = ("bullseye", "bookworm", "trixie", "sid")
+SEVERITIES = ((3.1, "LOW"), (5.3, "MEDIUM"), (7.5, "HIGH"), (9.8, "CRITICAL"))
+
+
+def cve_id_at(index):
+    """CVE ID number `index` of the generated fixtures, the same scheme as bench/fixtures.cpp."""
+    return f"CVE-{2000 + index % 25}-{1000 + index // 25:04d}"
+
+
+def seed_of(text):
+    return int.from_bytes(hashlib.sha1(text.encode()).digest()[:8], "little")
+
+
+def make_cve(cve_id):
+    seed = seed_of(cve_id)
+    score, severity = SEVERITIES[seed % len(SEVERITIES)]
+    return {
+        "id": cve_id,
+        "sourceIdentifier": "secalert@example.com",
+        "published": "2023-03-01T12:15:10.150",
+        "lastModified": "2024-01-10T08:20:41.017",
+        "vulnStatus": "Analyzed",
+        "descriptions": [
+            {"lang": "en", "value": f"A generated flaw number {seed % 100000} in a generated product."},
+        ],
+        "metrics": {
+            "cvssMetricV31": [{
+                "source": "nvd@nist.gov",
+                "type": "Primary",
+                "cvssData": {
+                    "version": "3.1",
+                    "vectorString": "CVSS:3.1/AV:N/AC:L/PR:N/UI:N/S:U/C:H/I:H/A:H",
+                    "baseScore": score,
+                    "baseSeverity": severity,
+                },
+            }],
+        },
+        "configurations": [{"nodes": [{"operator": "OR", "cpeMatch": [
+            {"vulnerable": True, "criteria": f"cpe:2.3:a:vendor:product:{i}:*:*:*:*:*:*:*"}
+            for i in range(20)
+        ]}]}],
+        "references": [
+            {"url": f"https://example.com/advisories/{cve_id}/{i}", "tags": ["Patch"]} for i in range(10)
+        ],
+    }
+
+
+def nvd_response(vulnerabilities, total, start=0):
+    return {
+        "resultsPerPage": len(vulnerabilities),
+        "startIndex": start,
+        "totalResults": total,
+        "format": "NVD_CVE",
+        "version": "2.0",
+        "timestamp": "2024-01-10T09:00:00.000",
+        "vulnerabilities": [{"cve": cve} for cve in vulnerabilities],
+    }
+
+
+def make_tracker(packages, cves_per_package=10):
+    """Tracker dump whose CVE IDs are cve_id_at(0) to cve_id_at(packages * cves_per_package * 3 // 4 - 1)."""
+    cves = max(packages * cves_per_package * 3 // 4, 1)
+    dump = {}
+    for package in range(packages):
+        entries = {}
+        for i in range(cves_per_package):
+            record = package * cves_per_package + i
+            releases = {}
+            for codename in CODENAMES:
+                seed = seed_of(f"{record}-{codename}")
+                version = f"{seed % 5}.{seed % 20}.{seed % 30}-1"
+                release = {"status": "resolved" if seed % 10 < 7 else "open",
+                           "repositories": {codename: version},
+                           "urgency": "not yet assigned"}
+                if release["status"] == "resolved":
+                    release["fixed_version"] = version
+                releases[codename] = release
+            entries[cve_id_at(record % cves)] = {"description": "Generated flaw", "releases": releases}
+        dump[f"package{package}"] = entries
+    return dump
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.counters = {"requests": 0, "nvd": 0, "tracker": 0, "notModified": 0, "forbidden": 0,
+                         "errors": 0, "retries": 0, "bytes": 0}
+        # Queries answered with 403 or 5xx, a repeated request for one of them is a retry
+        self.failed = set()
+
+    def request(self, route, query):
+        with self.lock:
+            self.counters["requests"] += 1
+            self.counters[route] += 1
+            if query in self.failed:
+                self.failed.discard(query)
+                self.counters["retries"] += 1
+
+    def failure(self, counter, query):
+        with self.lock:
+            self.counters[counter] += 1
+            self.failed.add(query)
+
+    def add(self, counter, value=1):
+        with self.lock:
+            self.counters[counter] += value
+
+    def snapshot(self):
+        with self.lock:
+            return dict(self.counters)
+
+
+class MockServer(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, address, args):
+        super().__init__(address, Handler)
+        self.args = args
+        self.stats = Stats()
+        self.random = random.Random(args.seed)
+        self.random_lock = threading.Lock()
+        self.started = time.time()
+        if args.tracker:
+            self.tracker = Path(args.tracker).read_bytes()
+        else:
+            self.tracker = json.dumps(make_tracker(args.tracker_packages)).encode()
+        self.tracker_gzip = gzip.compress(self.tracker, compresslevel=6)
+        self.tracker_digest = hashlib.sha1(self.tracker).hexdigest()[:16]
+
+    def chance(self, rate):
+        with self.random_lock:
+            return self.random.random() < rate
+
+    def delay(self):
+        with self.random_lock:
+            jitter = self.random.uniform(0, self.args.jitter)
+        return (self.args.latency + jitter) / 1000
+
+    def tracker_generation(self):
+        """Number of the current tracker version, bumped every --tracker-update-interval seconds."""
+        if not self.args.tracker_update_interval:
+            return 0
+        return int((time.time() - self.started) / self.args.tracker_update_interval)
+
+    def tracker_validators(self):
+        generation = self.tracker_generation()
+        modified = self.started + generation * (self.args.tracker_update_interval or 0)
+        return f'"{generation}-{self.tracker_digest}"', email.utils.formatdate(modified, usegmt=True)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "cveinfo-mock"
+
+    def log_message(self, format, *args):
+        if self.server.args.verbose:
+            super().log_message(format, *args)
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        if url.path == STATS_PATH:
+            self.reply(200, json.dumps(self.server.stats.snapshot()).encode())
+            return
+        if url.path not in (NVD_PATH, TRACKER_PATH):
+            self.reply(404, b'{"message": "not found"}')
+            return
+
+        route = "nvd" if url.path == NVD_PATH else "tracker"
+        self.server.stats.request(route, self.path)
+        time.sleep(self.server.delay())
+
+        args = self.server.args
+        if self.server.chance(args.forbidden_rate):
+            self.server.stats.failure("forbidden", self.path)
+            self.reply(403, b"", headers={"Retry-After": str(args.retry_after)})
+            return
+        if self.server.chance(args.error_rate):
+            self.server.stats.failure("errors", self.path)
+            self.reply(503 if self.server.chance(0.5) else 500, b"")
+            return
+
+        if route == "nvd":
+            self.nvd(parse_qs(url.query))
+        else:
+            self.tracker()
+
+    def nvd(self, query):
+        args = self.server.args
+        if "cveId" in query:
+            cve_id = query["cveId"][0]
+            fixture = Path(args.nvd_fixtures) / f"{cve_id}.json" if args.nvd_fixtures else None
+            if fixture and fixture.exists():
+                body = fixture.read_bytes()
+            else:
+                body = json.dumps(nvd_response([make_cve(cve_id)], 1)).encode()
+        else:
+            start = int(query.get("startIndex", ["0"])[0])
+            count = int(query.get("resultsPerPage", ["2000"])[0])
+            ids = range(start, min(start + count, args.total_results))
+            body = json.dumps(nvd_response([make_cve(cve_id_at(i)) for i in ids], args.total_results,
+                                           start)).encode()
+        self.reply(200, body, headers={"Content-Type": "application/json"})
+
+    def tracker(self):
+        etag, last_modified = self.server.tracker_validators()
+        headers = {"ETag": etag, "Last-Modified": last_modified}
+        if_none_match = self.headers.get("If-None-Match")
+        if (if_none_match == etag or
+                (not if_none_match and self.headers.get("If-Modified-Since") == last_modified)):
+            self.server.stats.add("notModified")
+            self.reply(304, b"", headers=headers)
+            return
+        headers["Content-Type"] = "application/json"
+        body = self.server.tracker
+        if "gzip" in self.headers.get("Accept-Encoding", ""):
+            headers["Content-Encoding"] = "gzip"
+            body = self.server.tracker_gzip
+        self.reply(200, body, headers=headers)
+
+    def reply(self, status, body, headers=None):
+        self.send_response(status)
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        if status == 304:
+            return
+        self.write(body)
+
+    def write(self, body):
+        """Writes `body`, paced to --bandwidth."""
+        bandwidth = self.server.args.bandwidth * 1024
+        if not bandwidth:
+            self.wfile.write(body)
+        else:
+            # 20 chunks a second keep the pacing smooth without too many syscalls
+            chunk = max(int(bandwidth / 20), 1)
+            for offset in range(0, len(body), chunk):
+                started = time.monotonic()
+                self.wfile.write(body[offset:offset + chunk])
+                time.sleep(max(chunk / bandwidth - (time.monotonic() - started), 0))
+        self.server.stats.add("bytes", len(body))
+
+
+def parse_args(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=0, help="0 picks a free port (default)")
+    parser.add_argument("--latency", type=float, default=0, help="added to every response, in ms")
+    parser.add_argument("--jitter", type=float, default=0, help="random extra latency up to this many ms")
+    parser.add_argument("--bandwidth", type=float, default=0, help="KiB/s per response, 0 is unlimited")
+    parser.add_argument("--forbidden-rate", type=float, default=0, help="share of requests answered with 403")
+    parser.add_argument("--retry-after", type=int, default=1, help="Retry-After of the 403 responses, in s")
+    parser.add_argument("--error-rate", type=float, default=0, help="share of requests answered with 500/503")
+    parser.add_argument("--tracker", help="tracker dump to serve instead of a generated one")
+    parser.add_argument("--tracker-packages", type=int, default=500, help="packages of the generated dump")
+    parser.add_argument("--tracker-update-interval", type=float, default=0,
+                        help="seconds after which the tracker gets a new ETag, 0 never")
+    parser.add_argument("--nvd-fixtures", help="directory of <CVE ID>.json responses to serve when present")
+    parser.add_argument("--total-results", type=int, default=2000, help="CVEs of the paged NVD queries")
+    parser.add_argument("--seed", type=int, default=0, help="seed of the random failures and latencies")
+    parser.add_argument("--verbose", action="store_true", help="log every request")
+    return parser.parse_args(argv)
+
+
+def main(argv=None):
+    args = parse_args(argv)
+    server = MockServer((args.host, args.port), args)
+    host, port = server.server_address[:2]
+    # The load harness waits for this line to learn the port
+    print(f"Listening on http://{host}:{port}", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print(json.dumps(server.stats.snapshot()), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())